@@ -4,9 +4,35 @@
 
 adc.cpp
 
+adc_calib.cpp
+
+adc_capture.cpp
+
+adc_control.cpp
+
+adc_filter.cpp
+
+adc_profile.cpp
+
+adc_stats.cpp
+
+adc_supply.cpp
+
+adc_window.cpp
+
+amp.cpp
+
 dac.cpp
 
+dac_dds.cpp
+
+dac_ramp.cpp
+
+dac_stream.cpp
+
 main.cpp
 
 uart.c
 
+vref.cpp
+
@@ -0,0 +1,331 @@
+/**
+* @file adc_capture.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the oscilloscope-style burst capture fed by the acquisition hook
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "adc_capture.h"
+
+extern "C" {
+	#include "uart.h"
+};
+
+/** Circular sample buffer */
+static void *adc_capture_buffer = NULL;
+/** Samples are stored with 8 bit (uint8_t) instead of 16 bit */
+static bool adc_capture_8bit = false;
+/** Number of samples of the buffer */
+static uint16_t adc_capture_size = 0;
+/** Write position in the buffer, position of the oldest sample when done */
+static volatile uint16_t adc_capture_pos = 0;
+/** Number of samples to record before the trigger is accepted */
+static volatile uint16_t adc_capture_pre = 0;
+/** Number of samples to record after the trigger */
+static volatile uint16_t adc_capture_post = 0;
+/** Number of post-trigger samples of the capture */
+static uint16_t adc_capture_post_trigger = 0;
+/** Captured channel */
+static uint8_t adc_capture_channel = 0;
+/** Trigger condition according to ::ADC_CAPTURE_TRIGGER */
+static uint8_t adc_capture_trigger = ADC_CAPTURE_EXTERNAL;
+/** Trigger level, signed for ::AMP0, ::AMP1 and ::AMP2 */
+static int16_t adc_capture_level = 0;
+/** Previous sample for the edge detection */
+static int16_t adc_capture_last = 0;
+/** Pending external trigger */
+static volatile bool adc_capture_external = false;
+/** Capture state according to ::ADC_CAPTURE_STATE */
+static volatile uint8_t adc_capture_state = ADC_CAPTURE_IDLE;
+
+
+/**
+* @brief Acquisition hook of the burst capture
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcCaptureHook(uint8_t channel, uint16_t value)
+{
+	uint8_t state = adc_capture_state;
+	
+	if (channel != adc_capture_channel || (state != ADC_CAPTURE_ARMED && state != ADC_CAPTURE_TRIGGERED))
+	{
+		return value;
+	}
+	
+	uint16_t pos = adc_capture_pos;
+	if (adc_capture_8bit)
+	{
+		((uint8_t *) adc_capture_buffer)[pos] = value >> 2;
+	}
+	else
+	{
+		((uint16_t *) adc_capture_buffer)[pos] = value;
+	}
+	if (++pos >= adc_capture_size) pos = 0;
+	adc_capture_pos = pos;
+	
+	if (state == ADC_CAPTURE_ARMED)
+	{
+		int16_t sample = adcSignedValue(channel, value);
+		
+		if (adc_capture_pre != 0)
+		{
+			// Pre-trigger part is not full yet
+			adc_capture_pre--;
+		}
+		else
+		{
+			bool triggered;
+			
+			switch (adc_capture_trigger)
+			{
+				case ADC_CAPTURE_RISING:
+				triggered = adc_capture_last < adc_capture_level && sample >= adc_capture_level;
+				break;
+				
+				case ADC_CAPTURE_FALLING:
+				triggered = adc_capture_last > adc_capture_level && sample <= adc_capture_level;
+				break;
+				
+				default:
+				triggered = adc_capture_external;
+				break;
+			}
+			
+			if (triggered)
+			{
+				state = (adc_capture_post == 0) ? ADC_CAPTURE_DONE : ADC_CAPTURE_TRIGGERED;
+			}
+		}
+		adc_capture_last = sample;
+	}
+	else if (--adc_capture_post == 0)
+	{
+		state = ADC_CAPTURE_DONE;
+	}
+	
+	adc_capture_state = state;
+	return value;
+}
+
+
+/**
+* @brief Function to arm a burst capture with 16 or 8 bit samples
+*
+* @param channel
+* Is the the captured ADC channel according to ::ADC_CH
+*
+* @param buffer
+* Is the sample buffer
+*
+* @param size
+* Is the number of samples of the buffer
+*
+* @param post_trigger
+* Is the number of samples recorded after the trigger sample (less than size)
+*
+* @param trigger
+* Is the trigger condition according to ::ADC_CAPTURE_TRIGGER
+*
+* @param level
+* Is the 10 bit trigger level, signed for ::AMP0, ::AMP1 and ::AMP2
+*
+* @param sample_8bit
+* Is true for a buffer of 8 bit samples
+*
+* @return Returns false if the parameters are invalid
+*/
+static bool adcCaptureArm(ADC_CH channel, void *buffer, uint16_t size, uint16_t post_trigger, ADC_CAPTURE_TRIGGER trigger, int16_t level, bool sample_8bit)
+{
+	if (buffer == NULL || size == 0 || post_trigger >= size) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_capture_buffer = buffer;
+		adc_capture_8bit = sample_8bit;
+		adc_capture_size = size;
+		adc_capture_pos = 0;
+		adc_capture_pre = size - post_trigger - 1;
+		adc_capture_post = post_trigger;
+		adc_capture_post_trigger = post_trigger;
+		adc_capture_channel = channel;
+		adc_capture_trigger = trigger;
+		adc_capture_level = level;
+		adc_capture_last = level;
+		adc_capture_external = false;
+		adc_capture_state = ADC_CAPTURE_ARMED;
+	}
+	adcHookSet(ADC_HOOK_CAPTURE, adcCaptureHook);
+	return true;
+}
+
+
+/**
+* @brief Function to arm a burst capture
+* Every conversion of the channel is written into the circular buffer. The trigger is
+* accepted once the pre-trigger part (size - post_trigger - 1 samples) is recorded.
+* After post_trigger further samples the buffer is frozen (::ADC_CAPTURE_DONE).
+* The samples have to be produced in the background, e.g. with
+* @code
+* adcCaptureStart(ADC3, buffer, sizeof(buffer)/sizeof(buffer[0]), 100, ADC_CAPTURE_RISING, 512);
+* adcContinuousStart(ADC3, ADC_TRIG_FREE_RUNNING, NULL, 0);
+* @endcode
+* The buffer size is chosen by the application to fit the SRAM (e.g. 1024 samples
+* on the ATmega64M1, 256 samples on the ATmega16M1).
+*
+* @param channel
+* Is the the captured ADC channel according to ::ADC_CH
+*
+* @param buffer
+* Is the sample buffer
+*
+* @param size
+* Is the number of samples of the buffer
+*
+* @param post_trigger
+* Is the number of samples recorded after the trigger sample (less than size)
+*
+* @param trigger
+* Is the trigger condition according to ::ADC_CAPTURE_TRIGGER
+*
+* @param level
+* Is the trigger level for ::ADC_CAPTURE_RISING and ::ADC_CAPTURE_FALLING,
+* signed (-512..511) for ::AMP0, ::AMP1 and ::AMP2
+*
+* @return Returns false if the parameters are invalid
+*/
+bool adcCaptureStart(ADC_CH channel, uint16_t *buffer, uint16_t size, uint16_t post_trigger, ADC_CAPTURE_TRIGGER trigger, int16_t level)
+{
+	return adcCaptureArm(channel, buffer, size, post_trigger, trigger, level, false);
+}
+
+
+/**
+* @brief Function to arm a burst capture with 8 bit samples
+* Works like adcCaptureStart(), but only the upper 8 bits are stored, so the same
+* memory holds twice as many samples. Combine it with adcContinuousStart8().
+*
+* @param channel
+* Is the the captured ADC channel according to ::ADC_CH
+*
+* @param buffer
+* Is the 8 bit sample buffer
+*
+* @param size
+* Is the number of samples of the buffer
+*
+* @param post_trigger
+* Is the number of samples recorded after the trigger sample (less than size)
+*
+* @param trigger
+* Is the trigger condition according to ::ADC_CAPTURE_TRIGGER
+*
+* @param level
+* Is the 8 bit trigger level for ::ADC_CAPTURE_RISING and ::ADC_CAPTURE_FALLING,
+* two's complement like the stored samples for ::AMP0, ::AMP1 and ::AMP2
+*
+* @return Returns false if the parameters are invalid
+*/
+bool adcCaptureStart8(ADC_CH channel, uint8_t *buffer, uint16_t size, uint16_t post_trigger, ADC_CAPTURE_TRIGGER trigger, uint8_t level)
+{
+	return adcCaptureArm(channel, buffer, size, post_trigger, trigger, adcSignedValue(channel, (uint16_t) level << 2), true);
+}
+
+
+/**
+* @brief Function to fire the trigger of a capture armed with ::ADC_CAPTURE_EXTERNAL
+* It may be called from an interrupt, the next sample of the channel is the trigger sample.
+*/
+void adcCaptureTrigger(void)
+{
+	adc_capture_external = true;
+}
+
+
+/**
+* @brief Function to stop the burst capture and release the acquisition hook
+*/
+void adcCaptureStop(void)
+{
+	adcHookSet(ADC_HOOK_CAPTURE, NULL);
+	adc_capture_state = ADC_CAPTURE_IDLE;
+}
+
+
+/**
+* @brief Function to read the state of the burst capture
+*
+* @return Returns the state according to ::ADC_CAPTURE_STATE
+*/
+ADC_CAPTURE_STATE adcCaptureState(void)
+{
+	return (ADC_CAPTURE_STATE) adc_capture_state;
+}
+
+
+/**
+* @brief Function to read a sample of a finished capture in chronological order
+* The trigger sample has the index size - post_trigger - 1.
+*
+* @param index
+* Is the index of the sample, 0 is the oldest sample
+*
+* @return Returns the sample (8 bit for adcCaptureStart8()) or 0 if the capture is not done
+*/
+uint16_t adcCaptureRead(uint16_t index)
+{
+	if (adc_capture_state != ADC_CAPTURE_DONE || index >= adc_capture_size) return 0;
+	
+	uint16_t pos = adc_capture_pos + index;
+	if (pos >= adc_capture_size) pos -= adc_capture_size;
+	if (adc_capture_8bit)
+	{
+		return ((uint8_t *) adc_capture_buffer)[pos];
+	}
+	return ((uint16_t *) adc_capture_buffer)[pos];
+}
+
+
+/**
+* @brief Function to transmit a finished capture via UART in one binary transfer
+* Format (all values little endian):
+* ::ADC_CAPTURE_SYNC0, ::ADC_CAPTURE_SYNC1, channel, bytes per sample (1 or 2), sample count (16 bit),
+* index of the trigger sample (16 bit), samples in chronological order.
+* Nothing is sent if the capture is not done.
+*/
+void adcCaptureDump(void)
+{
+	if (adc_capture_state != ADC_CAPTURE_DONE) return;
+	
+	uint16_t size = adc_capture_size;
+	uint16_t trigger_index = size - adc_capture_post_trigger - 1;
+	
+	uart_transmit(ADC_CAPTURE_SYNC0, NULL);
+	uart_transmit(ADC_CAPTURE_SYNC1, NULL);
+	uart_transmit(adc_capture_channel, NULL);
+	uart_transmit(adc_capture_8bit ? 1 : 2, NULL);
+	uart_transmit(size & 0xFF, NULL);
+	uart_transmit(size >> 8, NULL);
+	uart_transmit(trigger_index & 0xFF, NULL);
+	uart_transmit(trigger_index >> 8, NULL);
+	
+	for (uint16_t i = 0; i < size; i++)
+	{
+		uint16_t sample = adcCaptureRead(i);
+		uart_transmit(sample & 0xFF, NULL);
+		if (!adc_capture_8bit)
+		{
+			uart_transmit(sample >> 8, NULL);
+		}
+	}
+}
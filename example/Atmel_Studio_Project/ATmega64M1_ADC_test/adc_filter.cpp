@@ -0,0 +1,129 @@
+/**
+* @file adc_filter.cpp
+* @author Christoph Jurczyk
+* @date December 07, 2018
+* @brief This file contains the filter bank attached to the ADC acquisition path
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "adc_filter.h"
+
+/** First filter of the filter bank */
+static AdcFilter *adc_filter_list = NULL;
+
+
+/**
+* @brief Constructor of the filter base class
+*
+* @param channel
+* Is the the filtered ADC channel according to ::ADC_CH
+*/
+AdcFilter::AdcFilter(ADC_CH channel) : channel(channel), next(NULL), output(0), primed(false)
+{
+}
+
+
+/**
+* @brief Function to read the filtered value
+*
+* @return Returns the filtered value of the channel, signed for ::AMP0, ::AMP1 and ::AMP2
+*/
+int16_t AdcFilter::value(void)
+{
+	int16_t value;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = output;
+	}
+	return value;
+}
+
+
+/**
+* @brief Function to update the filter with a new sample
+* The base class passes the sample through.
+*
+* @param sample
+* Is the new conversion result of the channel, sign extended for ::AMP0, ::AMP1 and ::AMP2
+*/
+void AdcFilter::update(int16_t sample)
+{
+	output = sample;
+}
+
+
+/**
+* @brief Acquisition hook of the filter bank
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcFilterHook(uint8_t channel, uint16_t value)
+{
+	int16_t sample = adcSignedValue(channel, value);
+	
+	for (AdcFilter *filter = adc_filter_list; filter != NULL; filter = filter->next)
+	{
+		if (filter->channel == channel)
+		{
+			filter->update(sample);
+		}
+	}
+	return value;
+}
+
+
+/**
+* @brief Function to attach a filter to the acquisition path
+* The filter is updated by the ADC interrupt with every conversion result of its channel,
+* independent of the conversion mode. Several filters can be attached to the same channel.
+*
+* @param filter
+* Is the filter, it has to stay valid until it is detached and must not be attached twice
+*/
+void adcFilterAttach(AdcFilter *filter)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		filter->next = adc_filter_list;
+		adc_filter_list = filter;
+	}
+	adcHookSet(ADC_HOOK_FILTER, adcFilterHook);
+}
+
+
+/**
+* @brief Function to detach a filter from the acquisition path
+*
+* @param filter
+* Is the filter attached with adcFilterAttach()
+*/
+void adcFilterDetach(AdcFilter *filter)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		AdcFilter **link = &adc_filter_list;
+		
+		while (*link != NULL)
+		{
+			if (*link == filter)
+			{
+				*link = filter->next;
+				break;
+			}
+			link = &(*link)->next;
+		}
+	}
+	if (adc_filter_list == NULL)
+	{
+		adcHookSet(ADC_HOOK_FILTER, NULL);
+	}
+}
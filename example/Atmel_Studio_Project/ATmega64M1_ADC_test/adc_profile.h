@@ -0,0 +1,92 @@
+/**
+* @file adc_profile.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the latency and throughput instrumentation of the ADC driver
+*
+* The instrumentation is only compiled if ADC_PROFILE is defined for all files of the
+* project (e.g. -DADC_PROFILE), otherwise the macros compile to nothing.
+* Timer/Counter1 is used as time base, see adcProfileInit().
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_PROFILE_H_
+#define ADC_PROFILE_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+
+
+// ##### Definitions #####
+/**
+ *
+ * \enum    ADC_PROFILE_POINT
+ *
+ * \brief   Enum class for the measured sections of the ADC driver
+**/
+enum ADC_PROFILE_POINT {
+	/// Software start of a conversion until the ADC interrupt is entered
+	ADC_PROFILE_CONVERSION,
+	/// ADC interrupt (or adcPoll() processing) from entry to exit
+	ADC_PROFILE_ISR,
+	/// Call of adcRead()
+	ADC_PROFILE_READ,
+	/// Call of adcReadDiff()
+	ADC_PROFILE_READ_DIFF,
+	/// Call of adcTempRead()
+	ADC_PROFILE_TEMP_READ,
+	/// Number of measured sections
+	ADC_PROFILE_POINT_NUM
+	};
+
+/**
+ *
+ * \struct  ADC_PROFILE_STAT
+ *
+ * \brief   Structure of the latency statistics of a section in Timer/Counter1 ticks
+**/
+struct ADC_PROFILE_STAT {
+	/// Number of measurements
+	uint16_t count;
+	/// Minimum latency
+	uint16_t min;
+	/// Maximum latency
+	uint16_t max;
+	/// Sum of the latencies
+	uint32_t sum;
+	};
+
+
+#ifdef ADC_PROFILE
+/** Starts the measurement of a section with the time stamp variable var */
+#define ADC_PROFILE_BEGIN(var) uint16_t var = adcProfileTime()
+/** Ends the measurement of a section started with ADC_PROFILE_BEGIN(var) */
+#define ADC_PROFILE_END(point, var) adcProfileRecord(point, var)
+/** Marks the software start of a conversion */
+#define ADC_PROFILE_CONV_START() adcProfileConvStart()
+/** Marks the entry of the ADC interrupt, the time stamp is stored in var */
+#define ADC_PROFILE_ISR_ENTRY(var) uint16_t var = adcProfileIsrEntry()
+
+// ##### Functions #####
+void adcProfileInit(uint8_t clock_select);
+void adcProfileReset(void);
+uint16_t adcProfileTime(void);
+void adcProfileRecord(ADC_PROFILE_POINT point, uint16_t start);
+void adcProfileConvStart(void);
+uint16_t adcProfileIsrEntry(void);
+bool adcProfileGet(ADC_PROFILE_POINT point, ADC_PROFILE_STAT *stat);
+uint32_t adcProfileRate(uint32_t timer_hz);
+void adcProfileDump(uint32_t timer_hz);
+#else
+#define ADC_PROFILE_BEGIN(var)
+#define ADC_PROFILE_END(point, var)
+#define ADC_PROFILE_CONV_START()
+#define ADC_PROFILE_ISR_ENTRY(var)
+#endif
+
+
+#endif /* ADC_PROFILE_H_ */
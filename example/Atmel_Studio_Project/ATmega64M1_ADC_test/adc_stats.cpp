@@ -0,0 +1,219 @@
+/**
+* @file adc_stats.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the streaming statistics fed by the acquisition hook
+*
+*/
+
+#include <avr/io.h>
+#include <string.h>
+#include <util/atomic.h>
+#include "adc_stats.h"
+
+/** Channel value of a disabled accumulator */
+#define ADC_STATS_OFF 0xFF
+
+/** Accumulated channel of each accumulator */
+static uint8_t adc_stats_channel[ADC_STATS_NUM];
+/** Every decimation-th sample is added to sum and sumsq */
+static uint8_t adc_stats_decimation[ADC_STATS_NUM];
+/** Number of samples since the last accumulated one */
+static uint8_t adc_stats_phase[ADC_STATS_NUM];
+/** Accumulators */
+static ADC_STATS adc_stats[ADC_STATS_NUM];
+/** Number of the highest enabled accumulator + 1 */
+static volatile uint8_t adc_stats_count = 0;
+
+
+/**
+* @brief Function to reset an accumulator
+*
+* @param stats
+* Is the accumulator
+*/
+static void adcStatsReset(ADC_STATS *stats)
+{
+	memset(stats, 0, sizeof(ADC_STATS));
+	stats->min = 0x7FFF;
+	stats->max = -0x8000;
+}
+
+
+/**
+* @brief Acquisition hook of the statistics
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcStatsHook(uint8_t channel, uint16_t value)
+{
+	int16_t sample = adcSignedValue(channel, value);
+	
+	for (uint8_t i = 0; i < adc_stats_count; i++)
+	{
+		if (adc_stats_channel[i] != channel) continue;
+		
+		ADC_STATS *stats = &adc_stats[i];
+		
+		if (sample < stats->min) stats->min = sample;
+		if (sample > stats->max) stats->max = sample;
+		
+		if (++adc_stats_phase[i] < adc_stats_decimation[i]) continue;
+		adc_stats_phase[i] = 0;
+		
+		if (stats->count < ADC_STATS_MAX_COUNT)
+		{
+			stats->count++;
+			stats->sum += sample;
+			stats->sumsq += (uint32_t)((int32_t) sample * sample);
+		}
+		else if (stats->skipped != 0xFFFF)
+		{
+			stats->skipped++;
+		}
+	}
+	return value;
+}
+
+
+/**
+* @brief Function to start the statistics of a channel
+* Every conversion result of the channel updates min and max, no matter which conversion mode
+* produced it. Every decimation-th result is added to mean and variance, so a snapshot period
+* with more than ::ADC_STATS_MAX_COUNT conversions is still covered evenly.
+*
+* @param index
+* Is the number of the accumulator (0..ADC_STATS_NUM-1)
+*
+* @param channel
+* Is the the ADC channel according to ::ADC_CH
+*
+* @param decimation
+* Is the ratio of conversions to accumulated samples (1 accumulates every conversion)
+*
+* @return Returns false if the accumulator number is invalid
+*/
+bool adcStatsEnable(uint8_t index, ADC_CH channel, uint8_t decimation)
+{
+	if (index >= ADC_STATS_NUM) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adcStatsReset(&adc_stats[index]);
+		adc_stats_channel[index] = channel;
+		adc_stats_decimation[index] = decimation ? decimation : 1;
+		adc_stats_phase[index] = 0;
+		
+		if (index >= adc_stats_count)
+		{
+			// Disable the unused accumulators in between
+			for (uint8_t i = adc_stats_count; i < index; i++)
+			{
+				adc_stats_channel[i] = ADC_STATS_OFF;
+			}
+			adc_stats_count = index + 1;
+		}
+	}
+	adcHookSet(ADC_HOOK_STATS, adcStatsHook);
+	return true;
+}
+
+
+/**
+* @brief Function to stop the statistics of an accumulator
+*
+* @param index
+* Is the number of the accumulator (0..ADC_STATS_NUM-1)
+*/
+void adcStatsDisable(uint8_t index)
+{
+	if (index >= ADC_STATS_NUM) return;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_stats_channel[index] = ADC_STATS_OFF;
+		
+		while (adc_stats_count > 0 && adc_stats_channel[adc_stats_count - 1] == ADC_STATS_OFF)
+		{
+			adc_stats_count--;
+		}
+	}
+	
+	if (adc_stats_count == 0)
+	{
+		adcHookSet(ADC_HOOK_STATS, NULL);
+	}
+}
+
+
+/**
+* @brief Function to copy and reset the statistics of an accumulator in one atomic step
+* No sample is lost or counted twice between two snapshots.
+*
+* @param index
+* Is the number of the accumulator (0..ADC_STATS_NUM-1)
+*
+* @param stats
+* Is the destination of the statistics
+*
+* @return Returns false if the accumulator number is invalid
+*/
+bool adcStatsSnapshot(uint8_t index, ADC_STATS *stats)
+{
+	if (index >= ADC_STATS_NUM) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*stats = adc_stats[index];
+		adcStatsReset(&adc_stats[index]);
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to calculate the mean value of a snapshot
+*
+* @param stats
+* Is the snapshot
+*
+* @return Returns the rounded mean value or 0 if no sample was accumulated
+*/
+int16_t adcStatsMean(const ADC_STATS *stats)
+{
+	if (stats->count == 0) return 0;
+	
+	int32_t half = (stats->sum < 0) ? -(int32_t)(stats->count / 2) : (int32_t)(stats->count / 2);
+	return (stats->sum + half) / (int32_t) stats->count;
+}
+
+
+/**
+* @brief Function to calculate the variance of a snapshot
+* The squared deviations are summed around the rounded mean m, which keeps the calculation
+* in 32 bit: sumsq - 2*m*sum + n*m^2 is below 2^32 for 10 bit samples, so the arithmetic
+* modulo 2^32 gives the exact value.
+*
+* @param stats
+* Is the snapshot
+*
+* @return Returns the population variance in LSB^2 or 0 if no sample was accumulated
+*/
+uint32_t adcStatsVariance(const ADC_STATS *stats)
+{
+	if (stats->count == 0) return 0;
+	
+	uint16_t n = stats->count;
+	int16_t m = adcStatsMean(stats);
+	// Remaining offset of the mean, |d| <= n/2
+	int32_t d = stats->sum - (int32_t) n * m;
+	uint32_t squares = stats->sumsq - 2UL * (uint32_t) m * (uint32_t) stats->sum + (uint32_t) n * (uint32_t)((int32_t) m * m);
+	
+	return (squares - (uint32_t)(d * d) / n) / n;
+}
@@ -0,0 +1,67 @@
+/**
+* @file adc_stats.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the streaming ADC statistics
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_STATS_H_
+#define ADC_STATS_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** Number of statistics accumulators */
+#ifndef ADC_STATS_NUM
+#define ADC_STATS_NUM 4
+#endif
+
+/**
+ * Maximum number of accumulated samples per snapshot, 4096 * 1023^2 still fits into 32 bit.
+ * At a conversion rate of the channel f and a snapshot period T the decimation of
+ * adcStatsEnable() has to be at least f*T/::ADC_STATS_MAX_COUNT, e.g. 3 for 10 kHz and 1 s.
+ * Otherwise mean and variance only describe the first samples of the period (see skipped).
+**/
+#define ADC_STATS_MAX_COUNT 4096
+
+/**
+ *
+ * \struct  ADC_STATS
+ *
+ * \brief   Structure of the statistics of a channel
+ * Results of ::AMP0, ::AMP1 and ::AMP2 are accumulated as signed values.
+**/
+struct ADC_STATS {
+	/// Number of accumulated samples (every decimation-th sample)
+	uint16_t count;
+	/// Number of decimated samples after ::ADC_STATS_MAX_COUNT, only used for min and max
+	uint16_t skipped;
+	/// Minimum value of all samples
+	int16_t min;
+	/// Maximum value of all samples
+	int16_t max;
+	/// Sum of the values
+	int32_t sum;
+	/// Sum of the squared values
+	uint32_t sumsq;
+	};
+
+
+// ##### Functions #####
+bool adcStatsEnable(uint8_t index, ADC_CH channel, uint8_t decimation);
+void adcStatsDisable(uint8_t index);
+bool adcStatsSnapshot(uint8_t index, ADC_STATS *stats);
+int16_t adcStatsMean(const ADC_STATS *stats);
+uint32_t adcStatsVariance(const ADC_STATS *stats);
+
+
+#endif /* ADC_STATS_H_ */
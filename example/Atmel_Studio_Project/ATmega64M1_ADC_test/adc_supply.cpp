@@ -0,0 +1,137 @@
+/**
+* @file adc_supply.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the supply voltage monitor based on the bandgap channel
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "adc_supply.h"
+#include "vref.h"
+
+/** Last conversion result of the bandgap channel against AVcc, 0 if not measured */
+static uint16_t adc_supply_code = 0;
+/** Number of bandgap measurements */
+static volatile uint8_t adc_supply_sequence = 0;
+/** Supply voltage in mV calculated from the last bandgap result */
+static volatile uint16_t adc_supply_mv = ADC_SUPPLY_DEFAULT_MV;
+
+
+/**
+* @brief Acquisition hook of the supply monitor
+* Conversions of ::BANDGAP with AVcc as reference are recorded. The supply voltage
+* Vbg * 1024 / bandgap result is calculated here, only if the result changed.
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcSupplyHook(uint8_t channel, uint16_t value)
+{
+	if (channel == BANDGAP && vref_admux == AdcRefBits<ADC_INTERNAL_VCC_REF>::ADMUX_BITS && value != 0)
+	{
+		if (value != adc_supply_code)
+		{
+			adc_supply_code = value;
+			adc_supply_mv = ((uint32_t) ADC_BANDGAP_MV * 1024 + value / 2) / value;
+		}
+		adc_supply_sequence++;
+	}
+	return value;
+}
+
+
+/**
+* @brief Function to enable the supply monitor
+* Every conversion of ::BANDGAP with AVcc as reference (::ADC_INTERNAL_VCC_REF or
+* ::ADC_INTERNAL_VCC_EXT_CAP) updates the measured supply voltage. Add ::BANDGAP to the
+* table of the scan sequencer to refresh it in the background.
+*/
+void adcSupplyEnable(void)
+{
+	adcHookSet(ADC_HOOK_SUPPLY, adcSupplyHook);
+}
+
+
+/**
+* @brief Function to measure the supply voltage with a blocking conversion
+* Use it if no scan with ::BANDGAP is running. The supply monitor has to be enabled.
+*
+* @return Returns false during continuous conversions or a continuous scan
+*/
+bool adcSupplyMeasure(void)
+{
+	return adcRead(BANDGAP) != ADC_BUSY;
+}
+
+
+/**
+* @brief Function to read the number of bandgap measurements
+*
+* @return Returns the sequence counter
+*/
+uint8_t adcSupplySequence(void)
+{
+	return adc_supply_sequence;
+}
+
+
+/**
+* @brief Function to read the supply voltage
+* The voltage is calculated by the acquisition hook, so only the cached value is read.
+*
+* @return Returns the supply voltage in mV or ::ADC_SUPPLY_DEFAULT_MV if not measured yet
+*/
+uint16_t adcSupplyMillivolts(void)
+{
+	uint16_t mv;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		mv = adc_supply_mv;
+	}
+	return mv;
+}
+
+
+/**
+* @brief Function to convert a conversion result against AVcc to mV
+* The measured supply voltage is used as reference voltage, so the result is
+* correct even if the supply deviates from its nominal value.
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the voltage in mV
+*/
+uint16_t adcSupplyToMillivolts(uint16_t value)
+{
+	return ((uint32_t) value * adcSupplyMillivolts() + 512) >> 10;
+}
+
+
+/**
+* @brief Function to read an ADC channel in mV, corrected for the actual supply voltage
+* AVcc has to be selected as reference.
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @return Returns the voltage of the channel in mV or ::ADC_BUSY during continuous conversions or a continuous scan
+*/
+uint16_t adcReadMillivolts(ADC_CH channel)
+{
+	uint16_t value = adcRead(channel);
+	
+	if (value == ADC_BUSY)
+	{
+		return ADC_BUSY;
+	}
+	return adcSupplyToMillivolts(value);
+}
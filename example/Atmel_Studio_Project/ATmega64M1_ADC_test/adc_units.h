@@ -0,0 +1,258 @@
+/**
+* @file adc_units.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the integer conversion of ADC/DAC codes to mV, uV and engineering units
+*
+* All factors are calculated by the compiler, a conversion is one 32 bit multiplication
+* and a shift. No floating point support is needed.
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_UNITS_H_
+#define ADC_UNITS_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** Nominal voltage of AVcc (or of the AREF pin for an external reference) in mV */
+#ifndef ADC_AVCC_MV
+#define ADC_AVCC_MV 5000
+#endif
+
+
+/**
+ *
+ * \struct  AdcScale
+ *
+ * \brief   Compile-time multiply-shift constant for value * NUM / DEN
+ * The input has to be in the range of an ADC or DAC code (+-1023).
+ *
+ * @tparam NUM
+ * Is the numerator of the scale factor
+ *
+ * @tparam DEN
+ * Is the denominator of the scale factor
+ *
+ * @tparam SHIFT
+ * Is the number of fractional bits of the factor (1..16)
+**/
+template<uint32_t NUM, uint32_t DEN, uint8_t SHIFT>
+struct AdcScale {
+	/// Rounded factor NUM / DEN with SHIFT fractional bits
+	/// (split into integer and fractional part to avoid an overflow of NUM << SHIFT)
+	static const uint32_t MUL = (NUM / DEN) * (1UL << SHIFT) + ((NUM % DEN) * (1UL << SHIFT) + DEN / 2) / DEN;
+
+	enum { SHIFT_CHECK = sizeof(AdcStaticCheck<(SHIFT >= 1 && SHIFT <= 16 && DEN != 0 && DEN <= (0xFFFFFFFFUL >> SHIFT))>) };
+	enum { RANGE_CHECK = sizeof(AdcStaticCheck<((NUM / DEN) < (1UL << (21 - SHIFT)) && MUL < (1UL << 21))>) };
+
+	/**
+	* @brief Function to scale a value
+	*
+	* @param value
+	* Is the value to scale
+	*
+	* @return Returns the rounded value * NUM / DEN
+	*/
+	static inline int32_t apply(int16_t value)
+	{
+		return ((int32_t) value * (int32_t) MUL + (1L << (SHIFT - 1))) >> SHIFT;
+	}
+	};
+
+
+/**
+ *
+ * \struct  AdcRefMillivolts
+ *
+ * \brief   Compile-time voltage of a reference selection in mV
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF or ::DAC_REF
+ *
+ * @tparam AVCC_MV
+ * Is the voltage of AVcc resp. the AREF pin for an external reference in mV
+**/
+template<uint8_t REF, uint16_t AVCC_MV>
+struct AdcRefMillivolts {
+	/// Reference voltage in mV
+	static const uint16_t MV = (REF == ADC_INTERAL_2V56_CAP || REF == ADC_INTERNAL_2V56) ? 2560 : AVCC_MV;
+
+	enum { REF_CHECK = sizeof(AdcStaticCheck<(REF <= ADC_INTERNAL_2V56)>) };
+	};
+
+
+/**
+ *
+ * \struct  AdcUnits
+ *
+ * \brief   Conversion of single ended ADC codes and DAC codes
+ * Example:
+ * @code
+ * uint16_t mv = AdcUnits<ADC_INTERNAL_2V56>::millivolts(adcRead(ADC2));
+ * dacWrite(AdcUnits<DAC_INTERNAL_VCC_REF>::code(1250));
+ * @endcode
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF or ::DAC_REF
+ *
+ * @tparam AVCC_MV
+ * Is the voltage of AVcc resp. the AREF pin for an external reference in mV
+**/
+template<uint8_t REF, uint16_t AVCC_MV = ADC_AVCC_MV>
+struct AdcUnits {
+	/// Reference voltage in mV
+	static const uint16_t REF_MV = AdcRefMillivolts<REF, AVCC_MV>::MV;
+
+	/**
+	* @brief Function to convert a code to mV
+	*
+	* @param value
+	* Is the ADC/DAC code (0..1023)
+	*
+	* @return Returns the voltage in mV
+	*/
+	static inline uint16_t millivolts(uint16_t value)
+	{
+		return AdcScale<REF_MV, 1024, 16>::apply(value);
+	}
+
+	/**
+	* @brief Function to convert a code to uV
+	*
+	* @param value
+	* Is the ADC/DAC code (0..1023)
+	*
+	* @return Returns the voltage in uV
+	*/
+	static inline uint32_t microvolts(uint16_t value)
+	{
+		return AdcScale<REF_MV * 1000UL, 1024, 8>::apply(value);
+	}
+
+	/**
+	* @brief Function to convert a voltage to a code, e.g. for dacWrite()
+	*
+	* @param mv
+	* Is the voltage in mV
+	*
+	* @return Returns the code, limited to 1023
+	*/
+	static inline uint16_t code(uint16_t mv)
+	{
+		if (mv >= REF_MV) return 1023;
+		return ((uint32_t) mv * AdcScale<1024, REF_MV, 16>::MUL + 0x8000) >> 16;
+	}
+	};
+
+
+/**
+ *
+ * \struct  AdcDiffUnits
+ *
+ * \brief   Conversion of differential ADC codes (see adcReadDiff())
+ * A code of 512 equals Vref / gain.
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF
+ *
+ * @tparam GAIN
+ * Is the amplifier gain according to ::ADC_GAIN
+ *
+ * @tparam AVCC_MV
+ * Is the voltage of AVcc resp. the AREF pin for an external reference in mV
+**/
+template<uint8_t REF, ADC_GAIN GAIN, uint16_t AVCC_MV = ADC_AVCC_MV>
+struct AdcDiffUnits {
+	/// Reference voltage in mV
+	static const uint16_t REF_MV = AdcRefMillivolts<REF, AVCC_MV>::MV;
+	/// Code of a full scale differential voltage
+	static const uint32_t FULL_SCALE = 512UL * (5 << GAIN);
+
+	/**
+	* @brief Function to convert a differential code to mV
+	*
+	* @param value
+	* Is the differential code (-512..511)
+	*
+	* @return Returns the differential voltage in mV
+	*/
+	static inline int16_t millivolts(int16_t value)
+	{
+		return AdcScale<REF_MV, FULL_SCALE, 16>::apply(value);
+	}
+
+	/**
+	* @brief Function to convert a differential code to uV
+	*
+	* @param value
+	* Is the differential code (-512..511)
+	*
+	* @return Returns the differential voltage in uV
+	*/
+	static inline int32_t microvolts(int16_t value)
+	{
+		return AdcScale<REF_MV * 1000UL, FULL_SCALE, 8>::apply(value);
+	}
+	};
+
+
+/**
+ *
+ * \struct  AdcEngUnits
+ *
+ * \brief   Conversion of single ended ADC codes to an engineering unit
+ * A sensor with a linear output of OFFSET_MV at zero and MV_PER_UNIT per unit is
+ * converted to units * 10^DECIMALS, e.g. a LM35 (0mV, 10mV/degC) with one decimal:
+ * @code
+ * int16_t temp = AdcEngUnits<ADC_INTERNAL_2V56, 10, 0, 1>::value(adcRead(ADC3)); // 0.1 degC
+ * @endcode
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF
+ *
+ * @tparam MV_PER_UNIT
+ * Is the sensor sensitivity in mV per unit
+ *
+ * @tparam OFFSET_MV
+ * Is the sensor output at zero in mV
+ *
+ * @tparam DECIMALS
+ * Is the number of decimals of the result (0..3)
+ *
+ * @tparam AVCC_MV
+ * Is the voltage of AVcc resp. the AREF pin for an external reference in mV
+**/
+template<uint8_t REF, uint16_t MV_PER_UNIT, uint16_t OFFSET_MV = 0, uint8_t DECIMALS = 0, uint16_t AVCC_MV = ADC_AVCC_MV>
+struct AdcEngUnits {
+	/// Reference voltage in mV
+	static const uint16_t REF_MV = AdcRefMillivolts<REF, AVCC_MV>::MV;
+	/// Decimal scale of the result
+	static const uint16_t DECIMAL_SCALE = (DECIMALS == 0) ? 1 : (DECIMALS == 1) ? 10 : (DECIMALS == 2) ? 100 : 1000;
+	/// Code of the sensor offset
+	static const uint16_t OFFSET_CODE = ((uint32_t) OFFSET_MV * 1024 + REF_MV / 2) / REF_MV;
+
+	enum { DECIMALS_CHECK = sizeof(AdcStaticCheck<(DECIMALS <= 3 && MV_PER_UNIT != 0)>) };
+
+	/**
+	* @brief Function to convert a code to the engineering unit
+	*
+	* @param value
+	* Is the ADC code (0..1023)
+	*
+	* @return Returns the value in units * 10^DECIMALS
+	*/
+	static inline int32_t value(uint16_t value)
+	{
+		return AdcScale<(uint32_t) REF_MV * DECIMAL_SCALE, 1024UL * MV_PER_UNIT, 10>::apply((int16_t) value - (int16_t) OFFSET_CODE);
+	}
+	};
+
+
+#endif /* ADC_UNITS_H_ */
@@ -0,0 +1,137 @@
+/**
+* @file amp.cpp
+* @author Christoph Jurczyk
+* @date December 07, 2018
+* @brief This file contains the configuration of the differential amplifiers of the ATmega64M1
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "amp.h"
+
+/** Gain bit mask in AMPnCSR (identical for all amplifiers) */
+#define AMP_GAIN_MASK ((1 << AMP0G1)|(1 << AMP0G0))
+/** Clock source bit mask in AMPnCSR (identical for all amplifiers) */
+#define AMP_CLK_MASK ((1 << AMP0TS2)|(1 << AMP0TS1)|(1 << AMP0TS0))
+
+/** Shadow of AMP0CSR, AMP1CSR and AMP2CSR */
+static uint8_t amp_csr[3] = {0, 0, 0};
+
+
+/**
+* @brief Function to write an amplifier control register if the value changed
+*
+* @param index
+* Is the amplifier number (0 to 2)
+*
+* @param value
+* Is the new register value
+*/
+static void ampWrite(uint8_t index, uint8_t value)
+{
+	if (amp_csr[index] == value)
+	{
+		return;
+	}
+	amp_csr[index] = value;
+	
+	switch(index)
+	{
+		case 0:
+			AMP0CSR = value;
+		break;
+		
+		case 1:
+			AMP1CSR = value;
+		break;
+		
+		case 2:
+			AMP2CSR = value;
+		break;
+	}
+}
+
+
+/**
+* @brief Function to configure a differential amplifier
+* The amplifier is enabled with gain and clock source and the state is cached,
+* so later calls with the same settings do not access the register.
+* With a timer or PSC clock source the amplifier samples its input at a fixed point of
+* the timer or PWM period. Select the same event as ADC trigger (e.g. ::ADC_TRIG_PSC0_SYNC
+* for ::AMP0 with ::AMP_CLK_PSC_SYNC) to convert the sample right after it was taken.
+*
+* @param channel
+* Is the the desired amplifier channel ::AMP0, ::AMP1 or ::AMP2
+*
+* @param gain
+* Is the the desired gain according to ::ADC_GAIN
+*
+* @param clock
+* Is the the desired clock source according to ::AMP_CLK
+*
+* @return Returns false if the channel is not an amplifier channel
+*/
+bool ampConfig(ADC_CH channel, ADC_GAIN gain, AMP_CLK clock)
+{
+	if (channel < AMP0 || channel > AMP2)
+	{
+		return false;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ampWrite(channel - AMP0, (1 << AMP0EN) | ((gain << AMP0G0) & AMP_GAIN_MASK) | (clock & AMP_CLK_MASK));
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to enable a differential amplifier with a gain
+* The clock source is kept. The register is only written if the setting changes.
+* The function is used by adcReadDiff() and the scan sequencer.
+*
+* @param channel
+* Is the the desired amplifier channel ::AMP0, ::AMP1 or ::AMP2
+*
+* @param gain
+* Is the the desired gain according to ::ADC_GAIN
+*
+* @return Returns false if the channel is not an amplifier channel
+*/
+bool ampSetup(ADC_CH channel, ADC_GAIN gain)
+{
+	if (channel < AMP0 || channel > AMP2)
+	{
+		return false;
+	}
+	
+	uint8_t index = channel - AMP0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ampWrite(index, (amp_csr[index] & AMP_CLK_MASK) | (1 << AMP0EN) | ((gain << AMP0G0) & AMP_GAIN_MASK));
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to disable a differential amplifier
+*
+* @param channel
+* Is the the desired amplifier channel ::AMP0, ::AMP1 or ::AMP2
+*/
+void ampDisable(ADC_CH channel)
+{
+	if (channel < AMP0 || channel > AMP2)
+	{
+		return;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ampWrite(channel - AMP0, 0);
+	}
+}
@@ -0,0 +1,56 @@
+/**
+* @file amp.h
+* @author Christoph Jurczyk
+* @date December 07, 2018
+* @brief Header file for the differential amplifiers AMP0, AMP1 and AMP2
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef AMP_H_
+#define AMP_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/**
+ *
+ * \enum    AMP_CLK
+ *
+ * \brief   Enum class for possible amplifier clock (sampling trigger) sources
+ * The values are the AMPnTS2:0 bits, in the same order as the first trigger sources of ADTS.
+ * Each amplifier has a single PSC synchronization source: PSC module 0 for ::AMP0,
+ * module 1 for ::AMP1 and module 2 for ::AMP2. AMPnTS2:0 = 7 is reserved.
+**/
+enum AMP_CLK {
+	/// Automatic synchronization on ADC clock/8
+	AMP_CLK_ADC = 0,
+	/// Timer/Counter0 compare match A
+	AMP_CLK_TIMER0_COMP = 1,
+	/// Timer/Counter0 overflow
+	AMP_CLK_TIMER0_OVF = 2,
+	/// Timer/Counter1 compare match B
+	AMP_CLK_TIMER1_COMPB = 3,
+	/// Timer/Counter1 overflow
+	AMP_CLK_TIMER1_OVF = 4,
+	/// Timer/Counter1 capture event
+	AMP_CLK_TIMER1_CAPT = 5,
+	/// Synchronization signal of the PSC module of the amplifier
+	AMP_CLK_PSC_SYNC = 6,
+	};
+
+
+// ##### Functions #####
+bool ampConfig(ADC_CH channel, ADC_GAIN gain, AMP_CLK clock);
+bool ampSetup(ADC_CH channel, ADC_GAIN gain);
+void ampDisable(ADC_CH channel);
+
+
+#endif /* AMP_H_ */
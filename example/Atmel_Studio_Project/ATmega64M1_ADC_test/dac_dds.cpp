@@ -0,0 +1,197 @@
+/**
+* @file dac_dds.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the DDS waveform generator stepped by the DAC timer interrupt
+*
+*/
+
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "dac_dds.h"
+
+/** One period of a sine, amplitude 127 */
+static const int8_t dac_dds_sine[DAC_DDS_TABLE_SIZE] PROGMEM = {
+	   0,    3,    6,    9,   12,   16,   19,   22,   25,   28,   31,   34,   37,   40,   43,   46,
+	  49,   51,   54,   57,   60,   63,   65,   68,   71,   73,   76,   78,   81,   83,   85,   88,
+	  90,   92,   94,   96,   98,  100,  102,  104,  106,  107,  109,  111,  112,  113,  115,  116,
+	 117,  118,  120,  121,  122,  122,  123,  124,  125,  125,  126,  126,  126,  127,  127,  127,
+	 127,  127,  127,  127,  126,  126,  126,  125,  125,  124,  123,  122,  122,  121,  120,  118,
+	 117,  116,  115,  113,  112,  111,  109,  107,  106,  104,  102,  100,   98,   96,   94,   92,
+	  90,   88,   85,   83,   81,   78,   76,   73,   71,   68,   65,   63,   60,   57,   54,   51,
+	  49,   46,   43,   40,   37,   34,   31,   28,   25,   22,   19,   16,   12,    9,    6,    3,
+	   0,   -3,   -6,   -9,  -12,  -16,  -19,  -22,  -25,  -28,  -31,  -34,  -37,  -40,  -43,  -46,
+	 -49,  -51,  -54,  -57,  -60,  -63,  -65,  -68,  -71,  -73,  -76,  -78,  -81,  -83,  -85,  -88,
+	 -90,  -92,  -94,  -96,  -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+	-117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+	-127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+	-117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100,  -98,  -96,  -94,  -92,
+	 -90,  -88,  -85,  -83,  -81,  -78,  -76,  -73,  -71,  -68,  -65,  -63,  -60,  -57,  -54,  -51,
+	 -49,  -46,  -43,  -40,  -37,  -34,  -31,  -28,  -25,  -22,  -19,  -16,  -12,   -9,   -6,   -3,
+	};
+
+/** Selected waveform according to ::DAC_DDS_WAVE */
+static volatile uint8_t dac_dds_wave = DAC_DDS_SINE;
+/** Waveform table in flash */
+static const int8_t * volatile dac_dds_table = dac_dds_sine;
+/** Phase accumulator, the upper 8 bits are the table index */
+static uint16_t dac_dds_phase = 0;
+/** Phase increment per update */
+static volatile uint16_t dac_dds_increment = 0;
+/** Amplitude factor, the peak amplitude is about 2 * factor codes */
+static volatile uint8_t dac_dds_amplitude = 0;
+/** Output offset (center value) */
+static volatile uint16_t dac_dds_offset = 512;
+
+
+/**
+* @brief Update function of the DDS generator, called by the DAC timer interrupt
+* The run time is constant: phase accumulation, one table read or calculation,
+* an 8x8 bit multiplication, the limitation to the DAC range and the inline
+* DAC write dacWriteFast() (the DAC calibration is not applied).
+*/
+static void dacDdsTick(void)
+{
+	uint16_t phase = dac_dds_phase + dac_dds_increment;
+	uint8_t index = phase >> 8;
+	int8_t sample;
+	
+	dac_dds_phase = phase;
+	
+	switch (dac_dds_wave)
+	{
+		case DAC_DDS_TRIANGLE:
+		sample = (index < 128) ? (int8_t)(index * 2 - 127) : (int8_t)(383 - index * 2);
+		break;
+		
+		case DAC_DDS_SAWTOOTH:
+		sample = (int8_t)(index ^ 0x80);
+		break;
+		
+		default:
+		sample = (int8_t) pgm_read_byte(&dac_dds_table[index]);
+		break;
+	}
+	
+	// Scale (peak 127 * 255 / 64 = 506 codes) and add offset
+	int16_t value = (int16_t) dac_dds_offset + (((int16_t) sample * dac_dds_amplitude) >> 6);
+	
+	if (value < 0)
+	{
+		value = 0;
+	}
+	else if (value > 1023)
+	{
+		value = 1023;
+	}
+	dacWriteFast(value);
+}
+
+
+/**
+* @brief Function to start the DDS generator
+* The generator is driven by the DAC timer, e.g.
+* @code
+* dacTimerRateStart<20000>();
+* dacDdsFrequency(1000);
+* dacDdsAmplitude(400);
+* dacDdsStart(DAC_DDS_SINE, NULL);
+* sei();
+* @endcode
+*
+* @param wave
+* Is the waveform according to ::DAC_DDS_WAVE
+*
+* @param table
+* Is the waveform table in flash (PROGMEM) for ::DAC_DDS_TABLE, otherwise NULL
+*
+* @return Returns false if no table is given for ::DAC_DDS_TABLE
+*/
+bool dacDdsStart(DAC_DDS_WAVE wave, const int8_t *table)
+{
+	if (wave == DAC_DDS_TABLE && table == NULL) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_dds_wave = wave;
+		dac_dds_table = (wave == DAC_DDS_TABLE) ? table : dac_dds_sine;
+		dac_dds_phase = 0;
+	}
+	dacTickSet(dacDdsTick);
+	return true;
+}
+
+
+/**
+* @brief Function to stop the DDS generator, the output keeps its last value
+*/
+void dacDdsStop(void)
+{
+	dacTickSet(NULL);
+}
+
+
+/**
+* @brief Function to set the output frequency
+* The resolution is dacTimerRate() / 65536, so the DAC timer has to be started before.
+*
+* @param freq_hz
+* Is the desired frequency in Hz (below half of the update rate)
+*
+* @return Returns false if the frequency is not possible with the update rate
+*/
+bool dacDdsFrequency(uint16_t freq_hz)
+{
+	uint32_t rate = dacTimerRate();
+	
+	if (rate == 0 || 2UL * freq_hz >= rate) return false;
+	
+	dacDdsIncrement((((uint32_t) freq_hz << 16) + rate / 2) / rate);
+	return true;
+}
+
+
+/**
+* @brief Function to set the phase increment directly
+* The output frequency is increment * dacTimerRate() / 65536.
+*
+* @param increment
+* Is the phase increment per update
+*/
+void dacDdsIncrement(uint16_t increment)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_dds_increment = increment;
+	}
+}
+
+
+/**
+* @brief Function to set the amplitude
+*
+* @param amplitude
+* Is the peak amplitude in codes (0..510, resolution 2 codes)
+*/
+void dacDdsAmplitude(uint16_t amplitude)
+{
+	amplitude = (amplitude + 1) / 2;
+	dac_dds_amplitude = (amplitude > 255) ? 255 : amplitude;
+}
+
+
+/**
+* @brief Function to set the offset
+* The output is limited to 0..1023 if offset and amplitude exceed the DAC range.
+*
+* @param offset
+* Is the center value of the waveform in codes (0..1023)
+*/
+void dacDdsOffset(uint16_t offset)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_dds_offset = offset;
+	}
+}
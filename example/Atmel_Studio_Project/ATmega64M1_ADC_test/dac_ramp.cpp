@@ -0,0 +1,151 @@
+/**
+* @file dac_ramp.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the DAC ramp engine stepped by the DAC timer interrupt
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "dac_ramp.h"
+
+/** Current output value of the ramp */
+static volatile uint16_t dac_ramp_value = 0;
+/** Target value of the ramp */
+static volatile uint16_t dac_ramp_target = 0;
+/** Maximum change per update in codes */
+static volatile uint16_t dac_ramp_rate = 1;
+/** Target is reached */
+static volatile bool dac_ramp_done = true;
+
+
+/**
+* @brief Update function of the ramp engine, called by the DAC timer interrupt
+* The output moves by at most the rate towards the target. When the target is reached,
+* the done flag is set and the engine releases the DAC timer.
+*/
+static void dacRampTick(void)
+{
+	uint16_t value = dac_ramp_value;
+	uint16_t target = dac_ramp_target;
+	uint16_t rate = dac_ramp_rate;
+	
+	if (value < target)
+	{
+		value = (target - value > rate) ? value + rate : target;
+	}
+	else if (value > target)
+	{
+		value = (value - target > rate) ? value - rate : target;
+	}
+	
+	dac_ramp_value = value;
+	dacWriteFast(value);
+	
+	if (value == target)
+	{
+		dac_ramp_done = true;
+		dacTickSet(NULL);
+	}
+}
+
+
+/**
+* @brief Function to set the output immediately without a ramp
+* A running ramp is stopped. The value is the start value of the next ramp.
+*
+* @param value
+* Is the desired value (0-1023) of the DAC output.
+*/
+void dacRampSet(uint16_t value)
+{
+	dacRampStop();
+	if (value > 1023) value = 1023;
+	dac_ramp_value = value;
+	dac_ramp_target = value;
+	dacWriteFast(value);
+}
+
+
+/**
+* @brief Function to start a ramp to a target value
+* The output starts at the last value of the ramp engine (see dacRampSet()) and moves
+* by rate codes per update of the DAC timer, e.g.
+* @code
+* dacTimerRateStart<1000>();
+* dacRampSet(0);
+* dacRampTo(1023, 2); // about 0.5 s
+* sei();
+* while (!dacRampDone()) {}
+* @endcode
+* A new target can be set while a ramp is running. The DAC calibration is not applied.
+*
+* @param target
+* Is the target value (0-1023) of the DAC output
+*
+* @param rate
+* Is the maximum change per update in codes (at least 1)
+*
+* @return Returns false if the rate is 0
+*/
+bool dacRampTo(uint16_t target, uint16_t rate)
+{
+	if (rate == 0) return false;
+	if (target > 1023) target = 1023;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_ramp_target = target;
+		dac_ramp_rate = rate;
+		dac_ramp_done = false;
+	}
+	dacTickSet(dacRampTick);
+	return true;
+}
+
+
+/**
+* @brief Function to stop a running ramp, the output keeps its current value
+*/
+void dacRampStop(void)
+{
+	// Only release the DAC timer if the ramp engine uses it
+	if (!dac_ramp_done)
+	{
+		dacTickSet(NULL);
+	}
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_ramp_target = dac_ramp_value;
+		dac_ramp_done = true;
+	}
+}
+
+
+/**
+* @brief Function to check if the target is reached
+*
+* @return Returns true if no ramp is running
+*/
+bool dacRampDone(void)
+{
+	return dac_ramp_done;
+}
+
+
+/**
+* @brief Function to read the current output value of the ramp
+*
+* @return Returns the current value (0-1023)
+*/
+uint16_t dacRampValue(void)
+{
+	uint16_t value;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		value = dac_ramp_value;
+	}
+	return value;
+}
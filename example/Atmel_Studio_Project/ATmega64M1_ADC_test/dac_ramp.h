@@ -0,0 +1,30 @@
+/**
+* @file dac_ramp.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the DAC ramp engine (slew-rate limiter)
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef DAC_RAMP_H_
+#define DAC_RAMP_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "dac.h"
+
+
+// ##### Functions #####
+void dacRampSet(uint16_t value);
+bool dacRampTo(uint16_t target, uint16_t rate);
+void dacRampStop(void);
+bool dacRampDone(void);
+uint16_t dacRampValue(void);
+
+
+#endif /* DAC_RAMP_H_ */
@@ -0,0 +1,224 @@
+/**
+* @file dac_stream.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the double buffered DAC sample streaming from the UART
+*
+* Protocol: the host waits for a ::DAC_STREAM_CREDIT byte and answers with a ::DAC_STREAM_SYNC
+* byte and one block of block_size samples, each sample 16 bit little endian (0..1023).
+* Two credits are sent at the start, afterwards one credit for every block played out.
+* A high byte above 3 shows a lost byte, the block is dropped and the reception waits
+* for the next sync byte.
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "dac_stream.h"
+
+extern "C" {
+	#include "uart.h"
+};
+
+/** Sample blocks, two blocks of dac_stream_size samples */
+static uint16_t *dac_stream_buffer = NULL;
+/** Number of samples per block */
+static uint8_t dac_stream_size = 0;
+/** Block holds received samples which are not played out completely */
+static volatile bool dac_stream_full[2];
+/** Block filled by the receive handler */
+static uint8_t dac_stream_rx_block;
+/** Received bytes of the filled block plus one, 0 while waiting for the sync byte */
+static uint16_t dac_stream_rx_pos;
+/** The filled block is occupied, the received bytes are dropped */
+static bool dac_stream_rx_drop;
+/** Block played out by the DAC timer */
+static uint8_t dac_stream_play_block;
+/** Sample position in the played block */
+static uint8_t dac_stream_play_pos;
+/** The first block was played, missing samples are counted from now on */
+static bool dac_stream_playing;
+/** Number of credits to send */
+static volatile uint8_t dac_stream_credits;
+/** Number of DAC updates without a sample */
+static volatile uint16_t dac_stream_underruns = 0;
+/** Number of blocks dropped because the host sent without credit */
+static volatile uint16_t dac_stream_overruns = 0;
+
+
+/**
+* @brief Receive handler of the streaming, called by the LIN/UART interrupt
+*
+* @param byte_data
+* Is the received byte
+*/
+static void dacStreamReceive(uint8_t byte_data)
+{
+	uint8_t block = dac_stream_rx_block;
+	uint16_t pos = dac_stream_rx_pos;
+	
+	// Start of a block, or resync if a high byte (even position) is out of range
+	if (pos == 0 || ((pos & 1) == 0 && byte_data > 3))
+	{
+		if (byte_data == DAC_STREAM_SYNC)
+		{
+			// Host may only send into a free block
+			dac_stream_rx_drop = dac_stream_full[block];
+			dac_stream_rx_pos = 1;
+		}
+		else
+		{
+			dac_stream_rx_pos = 0;
+		}
+		return;
+	}
+	
+	if (!dac_stream_rx_drop)
+	{
+		uint8_t *bytes = (uint8_t *)(dac_stream_buffer + block * dac_stream_size);
+		bytes[pos - 1] = byte_data;
+	}
+	
+	if (pos++ >= 2 * dac_stream_size)
+	{
+		// Wait for the sync byte of the next block
+		pos = 0;
+		if (dac_stream_rx_drop)
+		{
+			if (dac_stream_overruns != 0xFFFF) dac_stream_overruns++;
+		}
+		else
+		{
+			// Hand over block to the DAC timer
+			dac_stream_full[block] = true;
+			dac_stream_rx_block = block ^ 1;
+		}
+	}
+	dac_stream_rx_pos = pos;
+}
+
+
+/**
+* @brief Update function of the streaming, called by the DAC timer interrupt
+* The samples are written with dacWriteFast(), the DAC calibration is not applied.
+*/
+static void dacStreamTick(void)
+{
+	uint8_t block = dac_stream_play_block;
+	
+	if (dac_stream_full[block])
+	{
+		dacWriteFast(dac_stream_buffer[block * dac_stream_size + dac_stream_play_pos]);
+		dac_stream_playing = true;
+		
+		if (++dac_stream_play_pos >= dac_stream_size)
+		{
+			// Release block and request the next one
+			dac_stream_play_pos = 0;
+			dac_stream_full[block] = false;
+			dac_stream_play_block = block ^ 1;
+			dac_stream_credits++;
+		}
+	}
+	else if (dac_stream_playing && dac_stream_underruns != 0xFFFF)
+	{
+		dac_stream_underruns++;
+	}
+	
+	// Send pending credit without waiting for the transmitter
+	if (dac_stream_credits != 0 && uart_transmit_try(DAC_STREAM_CREDIT))
+	{
+		dac_stream_credits--;
+	}
+}
+
+
+/**
+* @brief Function to start the sample streaming from the UART
+* Received blocks are played out at the rate of the DAC timer, e.g.
+* @code
+* static uint16_t buffer[2 * 32];
+* dacTimerRateStart<8000>();
+* dacStreamStart(buffer, 32);
+* sei();
+* @endcode
+* The UART is used in interrupt mode until dacStreamStop() is called.
+*
+* @param buffer
+* Is the sample buffer with space for 2*block_size samples
+*
+* @param block_size
+* Is the number of samples per block
+*
+* @return Returns false if the parameters are invalid
+*/
+bool dacStreamStart(uint16_t *buffer, uint8_t block_size)
+{
+	if (buffer == NULL || block_size == 0) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_stream_buffer = buffer;
+		dac_stream_size = block_size;
+		dac_stream_full[0] = false;
+		dac_stream_full[1] = false;
+		dac_stream_rx_block = 0;
+		dac_stream_rx_pos = 0;
+		dac_stream_rx_drop = false;
+		dac_stream_play_block = 0;
+		dac_stream_play_pos = 0;
+		dac_stream_playing = false;
+		dac_stream_credits = 2;
+		dac_stream_underruns = 0;
+		dac_stream_overruns = 0;
+	}
+	uart_rx_handler(dacStreamReceive);
+	dacTickSet(dacStreamTick);
+	return true;
+}
+
+
+/**
+* @brief Function to stop the sample streaming, the UART returns to polled reception
+*/
+void dacStreamStop(void)
+{
+	dacTickSet(NULL);
+	uart_rx_handler(NULL);
+}
+
+
+/**
+* @brief Function to read the number of DAC updates without a sample
+* Counting starts with the first played sample.
+*
+* @return Returns the number of underruns
+*/
+uint16_t dacStreamUnderruns(void)
+{
+	uint16_t underruns;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		underruns = dac_stream_underruns;
+	}
+	return underruns;
+}
+
+
+/**
+* @brief Function to read the number of dropped blocks
+* A block is dropped if the host sends it without credit.
+*
+* @return Returns the number of overruns
+*/
+uint16_t dacStreamOverruns(void)
+{
+	uint16_t overruns;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		overruns = dac_stream_overruns;
+	}
+	return overruns;
+}
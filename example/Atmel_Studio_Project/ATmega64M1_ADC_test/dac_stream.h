@@ -0,0 +1,41 @@
+/**
+* @file dac_stream.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the DAC sample streaming from the UART
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef DAC_STREAM_H_
+#define DAC_STREAM_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "dac.h"
+
+
+// ##### Definitions #####
+/** Flow control byte sent to the host for every free block */
+#ifndef DAC_STREAM_CREDIT
+#define DAC_STREAM_CREDIT 0x11
+#endif
+
+/** Sync byte sent by the host before every block, it can not be the high byte of a sample (0..3) */
+#ifndef DAC_STREAM_SYNC
+#define DAC_STREAM_SYNC 0xA5
+#endif
+
+
+// ##### Functions #####
+bool dacStreamStart(uint16_t *buffer, uint8_t block_size);
+void dacStreamStop(void);
+uint16_t dacStreamUnderruns(void);
+uint16_t dacStreamOverruns(void);
+
+
+#endif /* DAC_STREAM_H_ */
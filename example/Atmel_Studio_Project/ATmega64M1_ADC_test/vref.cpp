@@ -0,0 +1,123 @@
+/**
+* @file vref.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the voltage reference selection shared by ADC and DAC
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "vref.h"
+#include "adc.h"
+
+volatile uint8_t vref_mode = VREF_UNKNOWN;
+volatile uint8_t vref_admux = 0;
+
+/** REFS1:0 bits of each reference selection */
+static const uint8_t vref_admux_bits[] = {
+	AdcRefBits<ADC_EXTERNAL_REF>::ADMUX_BITS,
+	AdcRefBits<ADC_INTERNAL_VCC_EXT_CAP>::ADMUX_BITS,
+	AdcRefBits<ADC_INTERNAL_VCC_REF>::ADMUX_BITS,
+	AdcRefBits<ADC_INTERAL_2V56_CAP>::ADMUX_BITS,
+	AdcRefBits<ADC_INTERNAL_2V56>::ADMUX_BITS
+	};
+
+/** AREFEN bit of each reference selection */
+static const uint8_t vref_adcsrb_bits[] = {
+	AdcRefBits<ADC_EXTERNAL_REF>::ADCSRB_BITS,
+	AdcRefBits<ADC_INTERNAL_VCC_EXT_CAP>::ADCSRB_BITS,
+	AdcRefBits<ADC_INTERNAL_VCC_REF>::ADCSRB_BITS,
+	AdcRefBits<ADC_INTERAL_2V56_CAP>::ADCSRB_BITS,
+	AdcRefBits<ADC_INTERNAL_2V56>::ADCSRB_BITS
+	};
+
+
+/**
+* @brief Function to set the ADC/DAC voltage reference selection
+* The selection is kept in a shadow. If it does not change, no register is accessed
+* and no settling time is needed. Only the reference bits are changed, the selected
+* channel and the other bits of ADMUX and ADCSRB are kept.
+*
+* @param mode
+* Is the the desired mode according to ::ADC_REF or ::DAC_REF
+*
+* @return Returns the time in us the reference needs to settle, 0 if nothing changed
+*/
+uint16_t vrefSet(uint8_t mode)
+{
+	if (mode == vref_mode || mode > ADC_INTERNAL_2V56)
+	{
+		return 0;
+	}
+	
+	uint8_t admux_bits = vref_admux_bits[mode];
+	uint8_t adcsrb_bits = vref_adcsrb_bits[mode];
+	
+	// The ADC interrupt changes the channel bits of ADMUX
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADMUX = (ADMUX & ~VREF_ADMUX_MASK) | admux_bits;
+		ADCSRB = (ADCSRB & ~((1 << ISRCEN)|(1 << AREFEN))) | adcsrb_bits;
+		vref_admux = admux_bits;
+		vref_mode = mode;
+	}
+	
+	return vrefSettleTime();
+}
+
+
+/**
+* @brief Function to read the settling time of the reference after a change of the REFS bits
+* The time depends on the capacitor on the AREF pin (AREFEN bit).
+*
+* @return Returns the time in us the reference needs to settle
+*/
+uint16_t vrefSettleTime(void)
+{
+	if (ADCSRB & (1 << AREFEN))
+	{
+		return VREF_SETTLE_CAP_US;
+	}
+	return VREF_SETTLE_US;
+}
+
+
+/**
+* @brief Function to read the current ADC/DAC voltage reference selection
+* The shadow is returned. If the reference was never set, it is decoded from the registers.
+*
+* @return Returns the voltage reference selection as ::ADC_REF / ::DAC_REF value
+*/
+uint8_t vrefGet(void)
+{
+	if (vref_mode != VREF_UNKNOWN)
+	{
+		return vref_mode;
+	}
+	
+	uint8_t ref_value = ((ADMUX & VREF_ADMUX_MASK) >> REFS0); // shift REFS1/0 bits to the right
+
+	switch(ref_value)
+	{
+		case 1:
+			if(ADCSRB & (1 << AREFEN))
+			{
+				return ADC_INTERNAL_VCC_EXT_CAP;
+			} else {
+				return ADC_INTERNAL_VCC_REF;
+			}			
+		break;
+		
+		case 3:
+			if(ADCSRB & (1 << AREFEN))
+			{
+				return ADC_INTERAL_2V56_CAP;
+			} else {
+				return ADC_INTERNAL_2V56;
+			}
+		break;		
+	}
+	
+	return ADC_EXTERNAL_REF;
+}
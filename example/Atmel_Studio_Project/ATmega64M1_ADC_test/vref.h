@@ -0,0 +1,50 @@
+/**
+* @file vref.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the voltage reference shared by ADC and DAC
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef VREF_H_
+#define VREF_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+
+
+// ##### Definitions #####
+/** Shadow value of an unknown voltage reference selection (state after reset) */
+#define VREF_UNKNOWN 0xFF
+
+/** REFS1:0 bit mask in ADMUX */
+#define VREF_ADMUX_MASK ((1 << REFS1)|(1 << REFS0))
+
+/** Settling time in us after switching a reference without capacitor on the AREF pin */
+#ifndef VREF_SETTLE_US
+#define VREF_SETTLE_US 70
+#endif
+
+/** Settling time in us after switching a reference with external capacitor on the AREF pin */
+#ifndef VREF_SETTLE_CAP_US
+#define VREF_SETTLE_CAP_US 10000
+#endif
+
+/** Shadow of the voltage reference selection (::ADC_REF / ::DAC_REF value or ::VREF_UNKNOWN) */
+extern volatile uint8_t vref_mode;
+/** Shadow of the REFS1:0 bits in ADMUX, used to write ADMUX without reading it */
+extern volatile uint8_t vref_admux;
+
+
+// ##### Functions #####
+uint16_t vrefSet(uint8_t mode);
+uint8_t vrefGet(void);
+uint16_t vrefSettleTime(void);
+
+
+#endif /* VREF_H_ */
@@ -7,105 +7,169 @@
 */
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
 #include "adc.h"
+#include "vref.h"
+#include "amp.h"
+#include "adc_profile.h"
+
+#if (ADC_QUEUE_SIZE & (ADC_QUEUE_SIZE - 1)) != 0
+#error "ADC_QUEUE_SIZE has to be a power of two"
+#endif
+
+#ifndef ADC_F_CPU
+#error "F_CPU has to be defined for all files of the project (e.g. -DF_CPU=8000000UL) or ADC_F_CPU for adc.cpp"
+#endif
+
+#if (ADC_TEMP_SAMPLES & (ADC_TEMP_SAMPLES - 1)) != 0 || ADC_TEMP_SAMPLES > 64
+#error "ADC_TEMP_SAMPLES has to be a power of two up to 64"
+#endif
+
+/** REFS1:0 bits of the internal 2.56V reference */
+#define ADC_REFS_2V56 (AdcRefBits<ADC_INTERNAL_2V56>::ADMUX_BITS)
+/** Weight of the temperature average as power of two */
+#define ADC_TEMP_AVG_SHIFT 4
+
+/** Operating modes of the interrupt driven conversion engine */
+enum ADC_MODE {
+	/// No interrupt driven conversion running
+	ADC_MODE_IDLE,
+	/// Auto triggered conversions into the double buffered sample blocks
+	ADC_MODE_CONTINUOUS,
+	/// Scan sequencer working through a channel table
+	ADC_MODE_SCAN,
+	/// Accumulation of samples for an oversampled result
+	ADC_MODE_OVERSAMPLE,
+	/// Single conversion, result is latched for adcResult()
+	ADC_MODE_SINGLE
+	};
 
 /** Offset correction parameter for internal temperature sensor */
 int8_t temp_offset = 0;
+/** Running average of the temperature sensor with ADC_TEMP_AVG_SHIFT fractional bits */
+static volatile uint16_t adc_temp_avg;
+/** Running average of the temperature sensor holds a value */
+static volatile bool adc_temp_valid = false;
+
+/** REFS1:0 bits of the last channel selection */
+static uint8_t adc_refs = 0;
+/** Channel of the last channel selection */
+static uint8_t adc_mux_channel = 0;
+/** ADLAR bit of the channel selection, set for 8 bit conversions (only ADCH is read) */
+static volatile uint8_t adc_adlar = 0;
+/** Number of conversions to discard until the reference has settled */
+static volatile uint16_t adc_settle = 0;
+
+/** Current mode of the conversion engine */
+static volatile uint8_t adc_mode = ADC_MODE_IDLE;
+/** Channel of the running conversion */
+static volatile uint8_t adc_channel = 0;
+
+/** Sample queue, written by the ADC interrupt and read by the application */
+static ADC_SAMPLE adc_queue[ADC_QUEUE_SIZE];
+/** Write index of the sample queue (only changed by the ADC interrupt) */
+static volatile uint8_t adc_queue_head = 0;
+/** Read index of the sample queue (only changed by the application) */
+static volatile uint8_t adc_queue_tail = 0;
+/** Number of samples dropped due to a full queue */
+static volatile uint8_t adc_queue_overruns = 0;
+
+/** First of the double buffered sample blocks */
+static void *adc_block_buffer;
+/** Second of the double buffered sample blocks */
+static void *adc_block_second;
+/** Number of samples per block */
+static uint8_t adc_block_size;
+/** Samples are stored with 8 bit (uint8_t) instead of 16 bit */
+static bool adc_block_8bit;
+/** Block currently filled by the ADC interrupt */
+static void *adc_block_fill;
+/** Write position inside the filled block */
+static uint8_t adc_block_pos;
+/** Full block handed to the application, NULL if none is pending */
+static void * volatile adc_block_ready;
+/** Number of blocks overwritten because the application did not release the previous one */
+static volatile uint16_t adc_block_overruns = 0;
+
+/** Channel table of the scan sequencer */
+static const ADC_SCAN_ENTRY *adc_scan_table;
+/** Number of entries in the channel table */
+static uint8_t adc_scan_count;
+/** Index of the entry currently converted */
+static uint8_t adc_scan_index;
+/** Restart the scan after the last entry */
+static volatile bool adc_scan_continuous;
+/** Channel indexed result arrays, one is written by the ADC interrupt while the other holds the last complete scan */
+static uint16_t adc_scan_values[2][ADC_CH_NUM];
+/** Index of the result array holding the last complete scan */
+static volatile uint8_t adc_scan_front = 0;
+/** Number of completed scans */
+static volatile uint8_t adc_scan_sequence = 0;
+/** Channel table contains the temperature sensor */
+static volatile bool adc_scan_temp = false;
+
+/** Number of additional bits of the running oversampled conversion */
+static uint8_t adc_os_bits;
+/** Number of samples still to be accumulated */
+static uint8_t adc_os_remaining;
+/** Accumulated samples are signed (differential channel) */
+static bool adc_os_signed;
+/** Sum of the accumulated samples (at most 64 10 bit samples, two's complement for differential channels) */
+static uint16_t adc_os_sum;
+/** Decimated result of the last oversampled conversion */
+static volatile uint16_t adc_os_result = 0;
+
+/** Result of the last single conversion */
+static volatile uint16_t adc_result = 0;
+/** Result of a single conversion is ready */
+static volatile bool adc_ready = false;
+/** Callback of the running single conversion */
+static volatile ADC_CALLBACK adc_callback = NULL;
+
+/** Acquisition hook pipeline */
+static volatile ADC_HOOK adc_hooks[ADC_HOOK_NUM];
+
+/** Timer/Counter1 is running as trigger source */
+static volatile bool adc_timer_trigger = false;
+
+static void adcConversionComplete(void);
+static bool adcWaitIdle(void);
 
 /**
 * @brief Function to set the ADC/DAC voltage reference selection
 * The configuration of the voltage reference selection is applied to the ADC and DAC.
 * Independent voltage references are not possible.
+* The register bits are only written if the selection changes, see vrefSet().
+* For a reference known at compile time AdcConfig can be used instead.
+*
+* The conversions during the settling time are discarded by the conversion engine,
+* the returned time is only needed for the DAC output.
 *
 * @param mode
 * Is the the desired mode of the ADC/DAC according to ::ADC_REF
+*
+* @return Returns the time in us the reference needs to settle, 0 if nothing changed
 */
-void adcReference(ADC_REF mode)
+uint16_t adcReference(ADC_REF mode)
 {
-	switch(mode)
-	{
-		case ADC_EXTERNAL_REF:
-			ADMUX &= !((1 << REFS1)|(1 << REFS0));
-			ADCSRB &= !(1 << ISRCEN);
-			ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case ADC_INTERNAL_VCC_EXT_CAP:
-			ADMUX &= !((1 << REFS1));
-			ADMUX |= (1 << REFS0);
-			ADCSRB &= !(1 << ISRCEN);
-			ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case ADC_INTERNAL_VCC_REF:
-			ADMUX &= !((1 << REFS1));
-			ADMUX |= (1 << REFS0);
-			ADCSRB &= !(1 << ISRCEN);
-			ADCSRB &= !(1 << AREFEN);
-		break;
-		
-		case ADC_INTERAL_2V56_CAP:
-			ADMUX |= ((1 << REFS1)|(1 << REFS0));
-			ADCSRB &= !(1 << ISRCEN);
-			ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case ADC_INTERNAL_2V56:
-			ADMUX |= ((1 << REFS1)|(1 << REFS0));
-			ADCSRB &= !(1 << AREFEN);
-		break;	
-	}	
+	return vrefSet(mode);
 }
 
 
 
 /**
 * @brief Function to initialize ADC
+* For a configuration known at compile time AdcConfig can be used instead.
 *
 * @param clk_div_value
 * Is the the desired clock divider according to ::ADC_CLK_DIV
 */
 void adcInit(ADC_CLK_DIV clk_div_value)
 {
-	// Set clock divider
-	switch(clk_div_value)
-	{		
-		case ADC_CLK_DIV_2:
-			ADCSRA &= !((1 << ADPS2)|(1 << ADPS1)|(1 << ADPS0));
-		break;
-		
-		case ADC_CLK_DIV_4:
-			ADCSRA &= !((1 << ADPS2)|(1 << ADPS0));
-			ADCSRA |= (1 << ADPS1);
-		break;
-		
-		case ADC_CLK_DIV_8:
-			ADCSRA &= !(1 << ADPS2);
-			ADCSRA |= (1 << ADPS1)|(1 << ADPS0);
-		break;
-		
-		case ADC_CLK_DIV_16:
-			ADCSRA &= !((1 << ADPS1)|(1 << ADPS0));
-			ADCSRA |= (1 << ADPS2);
-		break;
-		
-		case ADC_CLK_DIV_32:
-			ADCSRA &= !(1 << ADPS1);
-			ADCSRA |= (1 << ADPS2)|(1 << ADPS0);
-		break;
-		
-		case ADC_CLK_DIV_64:
-			ADCSRA &= !(1 << ADPS0);
-			ADCSRA |= (1 << ADPS2)|(1 << ADPS1);
-		break;
-		
-		case ADC_CLK_DIV_128:
-			ADCSRA |= (1 << ADPS2)|(1 << ADPS1)|(1 << ADPS0);
-		break;
-	}
-	
-	// Enable ADC
-	ADCSRA |= (1 << ADEN);
+	// Set clock divider (ADPS = divider index + 1) and enable ADC
+	ADCSRA = (1 << ADEN) | ((clk_div_value + 1) & 0x07);
 	
 	// Dummy readout to prevent further error readings
 	ADCSRA |= (1 << ADSC);
@@ -114,24 +178,140 @@ void adcInit(ADC_CLK_DIV clk_div_value)
 }
 
 
+/**
+* @brief Function to calculate the number of conversions to discard after a reference change
+* The settling time of vrefSettleTime() is divided by the conversion time of 13 ADC clocks
+* at the prescaler in ADCSRA, at least ::ADC_REF_SETTLE conversions are discarded.
+* Only called when the reference bits change.
+*
+* @return Returns the number of conversions to discard
+*/
+static uint16_t adcSettleCount(void)
+{
+	// ADPS 0 and 1 both divide by 2
+	uint8_t adps = ADCSRA & 0x07;
+	uint32_t conversion = 13000UL << (adps ? adps : 1);
+	uint32_t count = ((uint32_t) vrefSettleTime() * (ADC_F_CPU / 1000UL) + conversion - 1) / conversion;
+	
+	if (count < ADC_REF_SETTLE)
+	{
+		return ADC_REF_SETTLE;
+	}
+	return count;
+}
+
+
+/**
+* @brief Function to calculate the ADMUX value for a channel
+* The reference bits are taken from the shadow of the vref module, so ADMUX is not read.
+* For ::TEMP_SENSOR the internal 2.56V reference is selected. If the reference bits differ
+* from the last selection, the conversions during the settling time are discarded (adcSettleCount()).
+* After switching to ::BANDGAP from another channel ::ADC_BANDGAP_SETTLE conversions are discarded.
+* The ADLAR bit is set for 8 bit conversions.
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @return Returns the ADMUX value
+*/
+static uint8_t adcMux(uint8_t channel)
+{
+	uint8_t refs = (channel == TEMP_SENSOR) ? ADC_REFS_2V56 : vref_admux;
+	
+	if (refs != adc_refs)
+	{
+		adc_refs = refs;
+		adc_settle = adcSettleCount();
+	}
+	if (channel == BANDGAP && adc_mux_channel != BANDGAP && adc_settle < ADC_BANDGAP_SETTLE)
+	{
+		adc_settle = ADC_BANDGAP_SETTLE;
+	}
+	adc_mux_channel = channel;
+	return refs | adc_adlar | (channel & 0x1F);
+}
+
+
+/**
+* @brief Function to switch the reference bits in ADMUX back to the ADC/DAC reference selection
+* Called after conversions of ::TEMP_SENSOR, so the DAC output is not scaled by the
+* internal 2.56V reference until the next conversion of another channel.
+* The conversions during the settling time are discarded.
+*/
+static void adcRefRestore(void)
+{
+	uint8_t refs = vref_admux;
+	
+	if (refs == adc_refs)
+	{
+		return;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADMUX = (ADMUX & ~VREF_ADMUX_MASK) | refs;
+	}
+	adc_refs = refs;
+	adc_settle = adcSettleCount();
+}
+
+
 /**
 * @brief Function to read ADC value
 *
 * @param channel
 * Is the the desired ADC channel according to ::ADC_CH
 *
-* @return Returns the value of the channel
+* @return Returns the value of the channel or ::ADC_BUSY during continuous conversions or a continuous scan
 */
 uint16_t adcRead(ADC_CH channel)
 {
-	// Select channel
-	ADMUX = (ADMUX & ~(0x1F)) | (channel & 0x1F);
+	ADC_PROFILE_BEGIN(profile_start);
+	// Wait for interrupt driven conversion to finish
+	if (!adcWaitIdle())
+	{
+		return ADC_BUSY;
+	}
 	// Start conversion
-	ADCSRA |= (1 << ADSC);
+	adcStart(channel);
 	// Wait for conversion finish
-	while ( ADCSRA & (1 << ADSC)){}
+	while (!adcPoll()){}
+	uint16_t value = adcResult();
+	ADC_PROFILE_END(ADC_PROFILE_READ, profile_start);
 	// Return value
-	return ADCW;
+	return value;
+}
+
+
+/**
+* @brief Function to read ADC value with 8 bit resolution
+* The result is left adjusted (ADLAR), so only ADCH is read. Use a high ADC clock
+* (::ADC_CLK_DIV_2 to ::ADC_CLK_DIV_8) for fast conversions, 8 bits are still accurate there.
+* The acquisition hooks receive the value shifted to 10 bit (value << 2).
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param value
+* Is the destination of the 8 bit value
+*
+* @return Returns false during continuous conversions or a continuous scan, value is unchanged then
+*/
+bool adcRead8(ADC_CH channel, uint8_t *value)
+{
+	// Wait for interrupt driven conversion to finish
+	if (!adcWaitIdle())
+	{
+		return false;
+	}
+	// Start left adjusted conversion
+	adc_adlar = (1 << ADLAR);
+	adcStart(channel);
+	// Wait for conversion finish
+	while (!adcPoll()){}
+	adc_adlar = 0;
+	*value = adcResult() >> 2;
+	return true;
 }
 
 
@@ -142,106 +322,24 @@ uint16_t adcRead(ADC_CH channel)
 * @param channel
 * Is the the desired ADC channel according to ::ADC_CH
 *
-* @return Returns the value of the channel
+* @return Returns the value of the channel, 0 for an invalid channel or during continuous conversions or a continuous scan
 */
 int16_t adcReadDiff(ADC_CH channel, ADC_GAIN gain)
 {
-	// Configure amplifier
-	switch(channel)
+	ADC_PROFILE_BEGIN(profile_start);
+	// Wait for interrupt driven conversion to finish and configure amplifier
+	if (!adcWaitIdle() || !ampSetup(channel, gain))
 	{
-		case AMP0:
-			AMP0CSR |= (1 << AMP0EN);
-			switch(gain)
-			{
-				case ADC_GAIN5:
-					AMP0CSR &= ~((1 << AMP0G1) | (1 << AMP0G0));
-				break;
-				
-				case ADC_GAIN10:
-					AMP0CSR &= ~(1 << AMP0G1);
-					AMP0CSR |= (1 << AMP0G0);
-				break;
-				
-				case ADC_GAIN20:
-					AMP0CSR &= ~(1 << AMP0G0);
-					AMP0CSR |= (1 << AMP0G1);
-				break;
-				
-				case ADC_GAIN40:
-					AMP0CSR |= (1 << AMP0G1) | (1 << AMP0G0);
-				break;
-			}			
-		break;
-		
-		case AMP1:
-			AMP1CSR |= (1 << AMP1EN);
-			switch(gain)
-			{
-				case ADC_GAIN5:
-				AMP1CSR &= ~((1 << AMP1G1) | (1 << AMP1G0));
-				break;
-				
-				case ADC_GAIN10:
-				AMP1CSR &= ~(1 << AMP1G1);
-				AMP1CSR |= (1 << AMP1G0);
-				break;
-				
-				case ADC_GAIN20:
-				AMP1CSR &= ~(1 << AMP1G0);
-				AMP1CSR |= (1 << AMP1G1);
-				break;
-				
-				case ADC_GAIN40:
-				AMP1CSR |= (1 << AMP1G1) | (1 << AMP1G0);
-				break;
-			}
-		break;
-		
-		case AMP2:
-			AMP2CSR |= (1 << AMP2EN);
-			switch(gain)
-			{
-				case ADC_GAIN5:
-				AMP2CSR &= ~((1 << AMP2G1) | (1 << AMP2G0));
-				break;
-				
-				case ADC_GAIN10:
-				AMP2CSR &= ~(1 << AMP2G1);
-				AMP2CSR |= (1 << AMP2G0);
-				break;
-				
-				case ADC_GAIN20:
-				AMP2CSR &= ~(1 << AMP2G0);
-				AMP2CSR |= (1 << AMP2G1);
-				break;
-				
-				case ADC_GAIN40:
-				AMP2CSR |= (1 << AMP2G1) | (1 << AMP2G0);
-				break;
-			}
-		break;
-		
-		default:
-			return 0;
-		break;
-	}	
-	// Select channel
-	ADMUX = (ADMUX & ~(0x1F)) | (channel & 0x1F);	
+		return 0;
+	}
 	// Start conversion
-	ADCSRA |= (1 << ADSC);
+	adcStart(channel);
 	// Wait for conversion finish
-	while ( ADCSRA & (1 << ADSC)){}
+	while (!adcPoll()){}
+	int16_t value = adcDiffSigned(adcResult());
+	ADC_PROFILE_END(ADC_PROFILE_READ_DIFF, profile_start);
 	// Return value
-	if (ADCW > 0x1FF)
-	{
-		return ADCW - 0x3FF;
-	} 
-	else
-	{
-		return ADCW;
-	}
-	
-	
+	return value;
 }
 
 /**
@@ -251,74 +349,83 @@ int16_t adcReadDiff(ADC_CH channel, ADC_GAIN gain)
 */
 ADC_REF adcGetReference(void)
 {
-	uint8_t ref_value = ((ADMUX & ((1 << REFS1)|(1 << REFS0))) >> REFS0); // shift REFS1/0 bits to the right
+	return (ADC_REF) vrefGet();
+}
 
-	switch(ref_value)
+/**
+* @brief Function to update the running average of the temperature sensor
+*
+* @param value
+* Is the conversion result of the temperature sensor
+*/
+static void adcTempUpdate(uint16_t value)
+{
+	if (adc_temp_valid)
 	{
-		case 0:
-			return ADC_EXTERNAL_REF;
-		break;
-			
-		case 1:
-			if(ADCSRB & (1 << AREFEN))
-			{
-				return ADC_INTERNAL_VCC_EXT_CAP;
-			} else {
-				return ADC_INTERNAL_VCC_REF;
-			}			
-		break;
-		
-		case 3:
-			if(ADCSRB & (1 << AREFEN))
-			{
-				return ADC_INTERAL_2V56_CAP;
-			} else {
-				return ADC_INTERNAL_2V56;
-			}
-		break;		
+		adc_temp_avg = adc_temp_avg - (adc_temp_avg >> ADC_TEMP_AVG_SHIFT) + value;
+	}
+	else
+	{
+		adc_temp_avg = value << ADC_TEMP_AVG_SHIFT;
+		adc_temp_valid = true;
 	}
-	
-	return ADC_EXTERNAL_REF;
 }
 
+
 /**
 * @brief Function to read internal temperature sensor
+* If a running scan contains ::TEMP_SENSOR, the continuously updated average of the scan is
+* returned immediately. Otherwise a blocking measurement of ::ADC_TEMP_SAMPLES conversions
+* is done with the internal 2.56V reference, which is switched back afterwards.
 *
-* @return Returns the internal temperature in DegC
+* @return Returns the internal temperature in DegC or ::ADC_TEMP_BUSY during continuous
+* conversions or a continuous scan without ::TEMP_SENSOR
 */
 int8_t adcTempRead(void)
 {
-	// Store previous reference selection
-	ADC_REF prevRefMode = adcGetReference();
-	// Switch to internal reference
-	adcReference(ADC_INTERNAL_2V56);
-	
-	// Read temperature
-	// Select channel
-	ADMUX = (ADMUX & ~(0x1F)) | (11 & 0x1F);
-	
-	// wait for multiplexer
-	uint8_t volatile i;	
-	for (i=0; i<255; i++);
+	ADC_PROFILE_BEGIN(profile_start);
+	uint16_t average;
 	
-	// Read multiple value from ADC to reduce noise
-	uint32_t sum = 0;
-	uint8_t nsamples = 100;
-		
-	for (uint8_t i = 0; i < nsamples; ++i ) {
-	// Start conversion
-	ADCSRA |= (1 << ADSC);
-	// Wait for conversion finish
-	while ( ADCSRA & (1 << ADSC)){}
-		sum += ADCW;
+	if (adc_mode == ADC_MODE_SCAN && adc_scan_temp && adc_temp_valid)
+	{
+		// Use average of the scan
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+		{
+			average = adc_temp_avg >> ADC_TEMP_AVG_SHIFT;
+		}
 	}
+	else
+	{
+		// Wait for interrupt driven conversion to finish
+		if (!adcWaitIdle())
+		{
+			return ADC_TEMP_BUSY;
+		}
+		
+		// Read multiple value from ADC to reduce noise, the reference is switched to 2.56V
+		// and the first conversions are discarded until the reference has settled
+		uint16_t sum = 0;
 		
+		for (uint8_t i = 0; i < ADC_TEMP_SAMPLES; ++i ) {
+			// Start conversion
+			adcStart(TEMP_SENSOR);
+			// Wait for conversion finish
+			while (!adcPoll()){}
+			sum += adcResult();
+		}
+		average = sum / ADC_TEMP_SAMPLES;
+		
+		// Switch back to the ADC/DAC reference
+		adcRefRestore();
+		
+		// Restart running average with this measurement
+		adc_temp_avg = average << ADC_TEMP_AVG_SHIFT;
+		adc_temp_valid = true;
+	}
 	
 	// Convert to degC
-	int16_t temperature = sum/nsamples - 280 + temp_offset;
-	
-	// Restore previous reference selection
-	adcReference(prevRefMode);
+	int16_t temperature = average - 280 + temp_offset;
+	ADC_PROFILE_END(ADC_PROFILE_TEMP_READ, profile_start);
 	
 	// Return value
 	return (int8_t) temperature;
@@ -327,7 +434,8 @@ int8_t adcTempRead(void)
 
 /**
 * @brief Function to set a offset correction of internal temperature measurement
-* Parameter should be stored in EEPROM and configured on startup with this function.
+* The parameter is part of the calibration table, so it is stored in the EEPROM with
+* adcCalibSave() and configured on startup by adcCalibLoad().
 *
 * @param offset
 * Is the the desired offset in degC
@@ -335,4 +443,944 @@ int8_t adcTempRead(void)
 void adcTempOffset(int8_t offset)
 {
 	temp_offset = offset;
+}
+
+
+/**
+* @brief Completion callback of adcConvStart(), pushes the result into the sample queue
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*/
+static void adcQueuePush(uint8_t channel, uint16_t value)
+{
+	uint8_t head = adc_queue_head;
+	uint8_t next = (head + 1) & (ADC_QUEUE_SIZE - 1);
+	
+	if (next == adc_queue_tail)
+	{
+		// Queue full, drop sample
+		adc_queue_overruns++;
+	}
+	else
+	{
+		adc_queue[head].channel = channel;
+		adc_queue[head].value = value;
+		adc_queue_head = next;
+	}
+}
+
+
+/**
+* @brief Function to start an interrupt driven conversion
+* The function returns immediately. After the conversion has finished the result
+* is pushed by the ADC interrupt into the sample queue and can be fetched with adcQueueRead().
+* Global interrupts have to be enabled with sei().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @return Returns true if the conversion was started, false if a conversion is already running
+*/
+bool adcConvStart(ADC_CH channel)
+{
+	return adcStartCallback(channel, adcQueuePush);
+}
+
+
+/**
+* @brief Function to check if an interrupt driven conversion is running
+*
+* @return Returns true while a conversion is running
+*/
+bool adcConvBusy(void)
+{
+	return adc_mode != ADC_MODE_IDLE;
+}
+
+
+/**
+* @brief Function to fetch the oldest sample from the sample queue
+*
+* @param sample
+* Is the destination of the sample according to ::ADC_SAMPLE
+*
+* @return Returns true if a sample was fetched, false if the queue is empty
+*/
+bool adcQueueRead(ADC_SAMPLE *sample)
+{
+	uint8_t tail = adc_queue_tail;
+	
+	if (tail == adc_queue_head)
+	{
+		return false;
+	}
+	*sample = adc_queue[tail];
+	// Release entry after copying it
+	adc_queue_tail = (tail + 1) & (ADC_QUEUE_SIZE - 1);
+	return true;
+}
+
+
+/**
+* @brief Function to read the number of samples in the sample queue
+*
+* @return Returns the number of queued samples
+*/
+uint8_t adcQueueCount(void)
+{
+	return (adc_queue_head - adc_queue_tail) & (ADC_QUEUE_SIZE - 1);
+}
+
+
+/**
+* @brief Function to read the number of samples dropped due to a full sample queue
+*
+* @return Returns the number of dropped samples
+*/
+uint8_t adcQueueOverruns(void)
+{
+	return adc_queue_overruns;
+}
+
+
+/**
+* @brief Function to start continuous auto triggered conversions with 16 or 8 bit sample blocks
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param trigger
+* Is the the desired auto trigger source according to ::ADC_TRIGGER
+*
+* @param buffer
+* Is the first sample block or NULL
+*
+* @param second
+* Is the second sample block or NULL
+*
+* @param block_size
+* Is the number of samples per block
+*
+* @param adlar
+* Is the ADLAR bit for 8 bit conversions or 0
+*
+* @return Returns true if the acquisition was started, false if a conversion is already running
+*/
+static bool adcContinuousBegin(ADC_CH channel, ADC_TRIGGER trigger, void *buffer, void *second, uint8_t block_size, uint8_t adlar)
+{
+	// Only one conversion mode at a time
+	if (adc_mode != ADC_MODE_IDLE || (buffer != NULL && block_size == 0))
+	{
+		return false;
+	}
+	
+	// Set up double buffer
+	adc_block_buffer = buffer;
+	adc_block_second = second;
+	adc_block_size = block_size;
+	adc_block_8bit = (adlar != 0);
+	adc_block_fill = buffer;
+	adc_block_pos = 0;
+	adc_block_ready = NULL;
+	adc_block_overruns = 0;
+	
+	adc_mode = ADC_MODE_CONTINUOUS;
+	adc_channel = channel;
+	adc_adlar = adlar;
+	
+	// Select channel
+	ADMUX = adcMux(channel);
+	// Select trigger source
+	ADCSRB = (ADCSRB & ~((1 << ADHSM)|0x0F)) | (trigger & 0x0F);
+	if (trigger == ADC_TRIG_FREE_RUNNING)
+	{
+		ADCSRB |= (1 << ADHSM);
+	}
+	// Enable auto trigger with conversion complete interrupt
+	ADCSRA |= (1 << ADATE)|(1 << ADIE);
+	// First conversion in free running mode is started manually
+	if (trigger == ADC_TRIG_FREE_RUNNING)
+	{
+		ADCSRA |= (1 << ADSC);
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to start continuous auto triggered conversions
+* Each trigger event of the selected source starts a conversion of the channel.
+* The ADC interrupt writes the results alternately into two blocks of
+* block_size samples. A full block is handed to the application with adcBlockGet()
+* and has to be released with adcBlockRelease() before the other block is full.
+* Otherwise the ADC interrupt overwrites its current block and counts an overrun.
+* In free running mode the ADC high speed mode is enabled to reach the maximum conversion rate.
+* Global interrupts have to be enabled with sei().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param trigger
+* Is the the desired auto trigger source according to ::ADC_TRIGGER
+*
+* @param buffer
+* Is the sample buffer with space for 2*block_size samples or NULL if the results
+* are only processed by the acquisition hooks (e.g. burst capture)
+*
+* @param block_size
+* Is the number of samples per block
+*
+* @return Returns true if the acquisition was started, false if a conversion is already running
+*/
+bool adcContinuousStart(ADC_CH channel, ADC_TRIGGER trigger, uint16_t *buffer, uint8_t block_size)
+{
+	return adcContinuousBegin(channel, trigger, buffer, (buffer != NULL) ? buffer + block_size : NULL, block_size, 0);
+}
+
+
+/**
+* @brief Function to start continuous auto triggered conversions with 8 bit samples
+* Works like adcContinuousStart(), but the results are left adjusted and only ADCH is
+* read and stored, which halves the buffer memory and the interrupt time. Fetch the
+* blocks with adcBlockGet8(). The acquisition hooks receive the value shifted to 10 bit (value << 2).
+* Use a high ADC clock (::ADC_CLK_DIV_2 to ::ADC_CLK_DIV_8) for high sample rates.
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param trigger
+* Is the the desired auto trigger source according to ::ADC_TRIGGER
+*
+* @param buffer
+* Is the sample buffer with space for 2*block_size samples or NULL if the results
+* are only processed by the acquisition hooks (e.g. 8 bit burst capture)
+*
+* @param block_size
+* Is the number of samples per block
+*
+* @return Returns true if the acquisition was started, false if a conversion is already running
+*/
+bool adcContinuousStart8(ADC_CH channel, ADC_TRIGGER trigger, uint8_t *buffer, uint8_t block_size)
+{
+	return adcContinuousBegin(channel, trigger, buffer, (buffer != NULL) ? buffer + block_size : NULL, block_size, (1 << ADLAR));
+}
+
+
+/**
+* @brief Function to stop continuous auto triggered conversions
+*/
+void adcContinuousStop(void)
+{
+	// Disable auto trigger and conversion complete interrupt
+	ADCSRA &= ~((1 << ADATE)|(1 << ADIE));
+	ADCSRB &= ~((1 << ADHSM)|0x0F);
+	// Wait for a running conversion to finish
+	while ( ADCSRA & (1 << ADSC)){}
+	adc_adlar = 0;
+	adc_mode = ADC_MODE_IDLE;
+}
+
+
+/**
+* @brief Function to fetch a full sample block of the continuous acquisition
+*
+* @return Returns a pointer to the block_size samples of the full block or NULL if no block is ready
+*/
+uint16_t *adcBlockGet(void)
+{
+	void *block;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		block = adc_block_ready;
+	}
+	return (uint16_t *) block;
+}
+
+
+/**
+* @brief Function to fetch a full 8 bit sample block of adcContinuousStart8()
+*
+* @return Returns a pointer to the block_size samples of the full block or NULL if no block is ready
+*/
+uint8_t *adcBlockGet8(void)
+{
+	return (uint8_t *) adcBlockGet();
+}
+
+
+/**
+* @brief Function to release the block fetched with adcBlockGet()
+* Afterwards the ADC interrupt can hand over the next block.
+*/
+void adcBlockRelease(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_block_ready = NULL;
+	}
+}
+
+
+/**
+* @brief Function to read the number of overwritten blocks of the continuous acquisition
+*
+* @return Returns the number of blocks lost because the application fell behind
+*/
+uint16_t adcBlockOverruns(void)
+{
+	uint16_t overruns;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		overruns = adc_block_overruns;
+	}
+	return overruns;
+}
+
+
+/**
+* @brief Function to select the channel of a scan table entry
+*
+* @param entry
+* Is the scan table entry according to ::ADC_SCAN_ENTRY
+*/
+static void adcScanSelect(const ADC_SCAN_ENTRY *entry)
+{
+	ampSetup(entry->channel, entry->gain);
+	adc_channel = entry->channel;
+	ADMUX = adcMux(entry->channel);
+}
+
+
+/**
+* @brief Function to start the scan sequencer
+* The channels of the table are converted one after the other. The ADC interrupt stores
+* each result, switches the multiplexer (and the amplifier gain of ::AMP0, ::AMP1 and ::AMP2)
+* and starts the next conversion. After the last entry the results are published as a
+* coherent snapshot and the sequence counter is incremented.
+* Differential channels are stored as signed value like returned by adcReadDiff().
+* For ::TEMP_SENSOR the reference is switched to 2.56V and back for this entry only,
+* the settling time is covered by discarded conversions (see vrefSettleTime()) and the
+* average returned by adcTempRead() is updated.
+* The table has to stay valid until the scan is stopped.
+* Global interrupts have to be enabled with sei().
+*
+* @param table
+* Is the channel table according to ::ADC_SCAN_ENTRY
+*
+* @param count
+* Is the number of entries in the table
+*
+* @param continuous
+* Restart with the first entry after the last one if true, otherwise stop after one scan
+*
+* @return Returns true if the scan was started, false if a conversion is already running
+*/
+bool adcScanStart(const ADC_SCAN_ENTRY *table, uint8_t count, bool continuous)
+{
+	// Only one conversion mode at a time
+	if (adc_mode != ADC_MODE_IDLE || count == 0)
+	{
+		return false;
+	}
+	
+	adc_scan_table = table;
+	adc_scan_count = count;
+	adc_scan_index = 0;
+	adc_scan_continuous = continuous;
+	adc_scan_temp = false;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (table[i].channel == TEMP_SENSOR)
+		{
+			adc_scan_temp = true;
+		}
+	}
+	
+	adc_mode = ADC_MODE_SCAN;
+	
+	// Select first entry
+	adcScanSelect(&table[0]);
+	// Start conversion with conversion complete interrupt
+	ADC_PROFILE_CONV_START();
+	ADCSRA |= (1 << ADSC)|(1 << ADIE);
+	return true;
+}
+
+
+/**
+* @brief Function to stop the scan sequencer
+* The running scan is completed and published before the sequencer stops.
+*/
+void adcScanStop(void)
+{
+	adc_scan_continuous = false;
+	// Wait for the running scan to finish
+	adcWaitIdle();
+}
+
+
+/**
+* @brief Function to read the number of completed scans
+* The counter can be polled to detect a new snapshot.
+*
+* @return Returns the sequence counter
+*/
+uint8_t adcScanSequence(void)
+{
+	return adc_scan_sequence;
+}
+
+
+/**
+* @brief Function to copy the results of the last complete scan
+*
+* @param values
+* Is the destination array of ::ADC_CH_NUM values, indexed by ::ADC_CH
+*
+* @return Returns the sequence counter of the copied scan
+*/
+uint8_t adcScanSnapshot(uint16_t *values)
+{
+	uint8_t sequence;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		const uint16_t *front = adc_scan_values[adc_scan_front];
+		
+		for (uint8_t i = 0; i < ADC_CH_NUM; i++)
+		{
+			values[i] = front[i];
+		}
+		sequence = adc_scan_sequence;
+	}
+	return sequence;
+}
+
+
+/**
+* @brief Function to start an interrupt driven oversampled conversion
+* The ADC interrupt accumulates 4^extra_bits conversions and decimates the sum
+* by extra_bits, which results in a (10+extra_bits) bit value.
+* The extension only works if the input carries at least 1 LSB of noise.
+* The samples of ::AMP0, ::AMP1 and ::AMP2 are accumulated as signed values, so noise
+* around zero is averaged instead of wrapping between 0 and 1023.
+* Check with adcConvBusy() for the end of the conversion and read the result with adcOversampleResult().
+* Global interrupts have to be enabled with sei().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param extra_bits
+* Is the number of additional bits (0 to ::ADC_OVERSAMPLE_MAX_BITS)
+*
+* @return Returns true if the conversion was started, false if a conversion is already running
+*/
+bool adcOversampleStart(ADC_CH channel, uint8_t extra_bits)
+{
+	// Only one conversion mode at a time
+	if (adc_mode != ADC_MODE_IDLE)
+	{
+		return false;
+	}
+	if (extra_bits > ADC_OVERSAMPLE_MAX_BITS)
+	{
+		extra_bits = ADC_OVERSAMPLE_MAX_BITS;
+	}
+	
+	adc_os_bits = extra_bits;
+	adc_os_remaining = 1 << (2 * extra_bits);
+	adc_os_signed = (channel >= AMP0 && channel <= AMP2);
+	adc_os_sum = 0;
+	
+	adc_mode = ADC_MODE_OVERSAMPLE;
+	adc_channel = channel;
+	
+	// Select channel
+	ADMUX = adcMux(channel);
+	// Start conversion with conversion complete interrupt
+	ADC_PROFILE_CONV_START();
+	ADCSRA |= (1 << ADSC)|(1 << ADIE);
+	return true;
+}
+
+
+/**
+* @brief Function to read the result of the last oversampled conversion
+*
+* @return Returns the (10+extra_bits) bit result, a signed value (cast to int16_t) for ::AMP0, ::AMP1 and ::AMP2
+*/
+uint16_t adcOversampleResult(void)
+{
+	uint16_t result;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		result = adc_os_result;
+	}
+	return result;
+}
+
+
+/**
+* @brief Function to read an oversampled ADC value
+* The function blocks until all 4^extra_bits conversions are done.
+* Global interrupts have to be enabled with sei().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param extra_bits
+* Is the number of additional bits (0 to ::ADC_OVERSAMPLE_MAX_BITS)
+*
+* @return Returns the (10+extra_bits) bit value of the channel, a signed value (cast to int16_t) for ::AMP0, ::AMP1 and ::AMP2,
+* or ::ADC_BUSY during continuous conversions or a continuous scan. For the differential channels ::ADC_BUSY equals the
+* result -1, check adcConvBusy() before the call.
+*/
+uint16_t adcReadOversampled(ADC_CH channel, uint8_t extra_bits)
+{
+	// Wait for interrupt driven conversion to finish
+	if (!adcWaitIdle())
+	{
+		return ADC_BUSY;
+	}
+	adcOversampleStart(channel, extra_bits);
+	adcWaitIdle();
+	return adc_os_result;
+}
+
+
+/**
+* @brief Function to start a single conversion
+* The function returns immediately. The end of the conversion is checked with
+* adcPoll() or adcReady() and the result is read with adcResult().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @return Returns true if the conversion was started, false if a conversion is already running
+*/
+bool adcStart(ADC_CH channel)
+{
+	return adcStartCallback(channel, NULL);
+}
+
+
+/**
+* @brief Function to start a single conversion with completion callback
+* The callback is called with the channel and the result at the end of the conversion,
+* from the ADC interrupt or, with disabled global interrupts, from adcPoll().
+* The result is also available with adcResult().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param callback
+* Is the completion callback or NULL
+*
+* @return Returns true if the conversion was started, false if a conversion is already running
+*/
+bool adcStartCallback(ADC_CH channel, ADC_CALLBACK callback)
+{
+	// Only one conversion at a time
+	if (adc_mode != ADC_MODE_IDLE)
+	{
+		return false;
+	}
+	adc_mode = ADC_MODE_SINGLE;
+	adc_channel = channel;
+	adc_callback = callback;
+	adc_ready = false;
+	
+	// Select channel
+	ADMUX = adcMux(channel);
+	// Start conversion with conversion complete interrupt
+	ADC_PROFILE_CONV_START();
+	ADCSRA |= (1 << ADSC)|(1 << ADIE);
+	return true;
+}
+
+
+/**
+* @brief Function to process a finished conversion without interrupts
+* With enabled global interrupts the ADC interrupt does the work and the function
+* only returns the state. With disabled global interrupts the conversion complete
+* flag is checked and the result is processed like in the ADC interrupt.
+*
+* @return Returns true if the result of the single conversion is ready
+*/
+bool adcPoll(void)
+{
+	if (!(SREG & (1 << SREG_I)) && (ADCSRA & (1 << ADIF)))
+	{
+		// Clear flag and process conversion
+		ADCSRA |= (1 << ADIF);
+		ADC_PROFILE_ISR_ENTRY(profile_start);
+		adcConversionComplete();
+		ADC_PROFILE_END(ADC_PROFILE_ISR, profile_start);
+	}
+	return adc_ready;
+}
+
+
+/**
+* @brief Function to check if the result of the single conversion is ready
+*
+* @return Returns true if the result is ready
+*/
+bool adcReady(void)
+{
+	return adc_ready;
+}
+
+
+/**
+* @brief Function to read the result of the last single conversion
+*
+* @return Returns the value of the channel
+*/
+uint16_t adcResult(void)
+{
+	uint16_t result;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		result = adc_result;
+		adc_ready = false;
+	}
+	return result;
+}
+
+
+/**
+* @brief Function to read ADC value in ADC Noise Reduction sleep mode
+* The CPU sleeps during the conversion, which removes the digital noise of the core.
+* The conversion is started by entering the sleep mode and the ADC interrupt wakes the CPU up.
+* If another interrupt wakes the CPU before, it is handled and the CPU goes back to sleep
+* until the conversion is finished. Global interrupts are enabled during the sleep and
+* restored afterwards. The I/O clock is halted in this sleep mode, so timers and the UART
+* stop during the conversion. Wait for pending UART transmissions before calling the function.
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @return Returns the value of the channel or ::ADC_BUSY during continuous conversions or a continuous scan
+*/
+uint16_t adcReadSleep(ADC_CH channel)
+{
+	// Wait for interrupt driven conversion to finish
+	if (!adcWaitIdle())
+	{
+		return ADC_BUSY;
+	}
+	
+	uint8_t sreg = SREG;
+	cli();
+	
+	// Arm single conversion, entering the sleep mode starts it
+	adc_mode = ADC_MODE_SINGLE;
+	adc_channel = channel;
+	adc_callback = NULL;
+	adc_ready = false;
+	ADMUX = adcMux(channel);
+	ADCSRA |= (1 << ADIE);
+	
+	set_sleep_mode(SLEEP_MODE_ADC);
+	while (!adc_ready)
+	{
+		// Interrupts are enabled with the instruction after sei, so no wake-up is lost
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+		cli();
+	}
+	
+	SREG = sreg;
+	return adcResult();
+}
+
+
+/**
+* @brief Function to read averaged ADC value in ADC Noise Reduction sleep mode
+* Every conversion is done with adcReadSleep().
+*
+* @param channel
+* Is the the desired ADC channel according to ::ADC_CH
+*
+* @param nsamples
+* Is the number of averaged conversions (at least 1)
+*
+* @return Returns the averaged value of the channel or ::ADC_BUSY during continuous conversions or a continuous scan
+*/
+uint16_t adcReadSleepAvg(ADC_CH channel, uint8_t nsamples)
+{
+	uint32_t sum = 0;
+	
+	if (nsamples == 0)
+	{
+		nsamples = 1;
+	}
+	for (uint8_t i = 0; i < nsamples; i++)
+	{
+		uint16_t value = adcReadSleep(channel);
+		
+		if (value == ADC_BUSY)
+		{
+			return ADC_BUSY;
+		}
+		sum += value;
+	}
+	return sum / nsamples;
+}
+
+
+/**
+* @brief Function to wait until the conversion engine is idle
+* Continuous conversions and a continuous scan never finish on their own, so
+* the function does not wait for them.
+*
+* @return Returns true if the engine is idle, false during continuous conversions or a continuous scan
+*/
+static bool adcWaitIdle(void)
+{
+	uint8_t mode;
+	
+	while ((mode = adc_mode) != ADC_MODE_IDLE)
+	{
+		if (mode == ADC_MODE_CONTINUOUS || (mode == ADC_MODE_SCAN && adc_scan_continuous))
+		{
+			return false;
+		}
+		adcPoll();
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to install a hook in the acquisition pipeline
+* The ADC interrupt calls the installed hooks in the order of ::ADC_HOOK_SLOT for
+* every conversion result, before the result is handled by the conversion mode.
+*
+* @param slot
+* Is the pipeline slot according to ::ADC_HOOK_SLOT
+*
+* @param hook
+* Is the hook function or NULL to remove the hook
+*/
+void adcHookSet(ADC_HOOK_SLOT slot, ADC_HOOK hook)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_hooks[slot] = hook;
+	}
+}
+
+
+/**
+* @brief Function to start Timer/Counter1 as ADC trigger source
+* Timer/Counter1 runs in CTC mode with OCR1A as TOP. The compare match B flag is raised
+* once per period and starts a conversion when ::ADC_TRIG_TIMER1_COMPB is selected.
+* The ADC interrupt clears the flag, so no timer interrupt is needed.
+* Use adcSampleRateStart() to calculate the values from a sample rate at compile time.
+*
+* @param clock_select
+* Is the Timer/Counter1 clock select value (CS12:0)
+*
+* @param top
+* Is the TOP value, the sample period is (top+1)*prescaler/F_CPU
+*/
+void adcTimerStart(uint8_t clock_select, uint16_t top)
+{
+	// Stop timer
+	TCCR1B = 0;
+	TCCR1A = 0;
+	TCNT1 = 0;
+	OCR1A = top;
+	OCR1B = top;
+	// Clear pending compare match flag to get a rising edge on the first match
+	TIFR1 = (1 << OCF1B);
+	adc_timer_trigger = true;
+	// Start timer in CTC mode
+	TCCR1B = (1 << WGM12) | (clock_select & 0x07);
+}
+
+
+/**
+* @brief Function to stop Timer/Counter1 as ADC trigger source
+*/
+void adcTimerStop(void)
+{
+	TCCR1B = 0;
+	adc_timer_trigger = false;
+}
+
+
+/**
+* @brief Function to process a finished conversion according to the conversion mode
+*/
+static void adcConversionComplete(void)
+{
+	// 8 bit conversions only read ADCH, the pipeline always works with 10 bit values
+	uint16_t value = adc_adlar ? ((uint16_t) ADCH << 2) : ADCW;
+	
+	// Re-arm timer trigger
+	if (adc_timer_trigger)
+	{
+		TIFR1 = (1 << OCF1B);
+	}
+	
+	// Discard conversions until the reference has settled
+	if (adc_settle != 0)
+	{
+		adc_settle--;
+		if (!(ADCSRA & (1 << ADATE)))
+		{
+			ADCSRA |= (1 << ADSC);
+		}
+		return;
+	}
+	
+	// Run acquisition pipeline
+	for (uint8_t i = 0; i < ADC_HOOK_NUM; i++)
+	{
+		ADC_HOOK hook = adc_hooks[i];
+		if (hook != NULL)
+		{
+			value = hook(adc_channel, value);
+		}
+	}
+	
+	switch(adc_mode)
+	{
+		case ADC_MODE_CONTINUOUS:
+		{
+			void *block = adc_block_fill;
+			
+			// Results are only used by the hooks
+			if (block == NULL) break;
+			
+			if (adc_block_8bit)
+			{
+				((uint8_t *) block)[adc_block_pos] = value >> 2;
+			}
+			else
+			{
+				((uint16_t *) block)[adc_block_pos] = value;
+			}
+			if (++adc_block_pos >= adc_block_size)
+			{
+				adc_block_pos = 0;
+				if (adc_block_ready != NULL)
+				{
+					// Application still holds the other block, overwrite current one
+					adc_block_overruns++;
+				}
+				else
+				{
+					// Hand over full block and continue with the other one
+					adc_block_ready = block;
+					adc_block_fill = (block == adc_block_buffer) ? adc_block_second : adc_block_buffer;
+				}
+			}
+		}
+		break;
+		
+		case ADC_MODE_SCAN:
+		{
+			uint8_t channel = adc_channel;
+			
+			// Store result in the back array
+			if (channel >= AMP0 && channel <= AMP2)
+			{
+				value = adcDiffSigned(value);
+			}
+			else if (channel == TEMP_SENSOR)
+			{
+				adcTempUpdate(value);
+			}
+			adc_scan_values[adc_scan_front ^ 1][channel] = value;
+			
+			if (++adc_scan_index >= adc_scan_count)
+			{
+				// Publish snapshot
+				adc_scan_index = 0;
+				adc_scan_front ^= 1;
+				adc_scan_sequence++;
+				
+				if (!adc_scan_continuous)
+				{
+					ADCSRA &= ~(1 << ADIE);
+					adc_mode = ADC_MODE_IDLE;
+					// Switch back to the ADC/DAC reference if the table ends with ::TEMP_SENSOR
+					adcRefRestore();
+					break;
+				}
+			}
+			
+			// Switch to next entry and start conversion
+			adcScanSelect(&adc_scan_table[adc_scan_index]);
+			ADCSRA |= (1 << ADSC);
+		}
+		break;
+		
+		case ADC_MODE_SINGLE:
+		{
+			ADC_CALLBACK callback = adc_callback;
+			
+			adc_result = value;
+			adc_ready = true;
+			ADCSRA &= ~(1 << ADIE);
+			adc_mode = ADC_MODE_IDLE;
+			if (callback != NULL)
+			{
+				callback(adc_channel, value);
+			}
+		}
+		break;
+		
+		case ADC_MODE_OVERSAMPLE:
+			// 64 signed samples (-32768..32704) still fit the 16 bit accumulator as two's complement
+			if (adc_os_signed)
+			{
+				value = adcDiffSigned(value);
+			}
+			adc_os_sum += value;
+			if (--adc_os_remaining == 0)
+			{
+				// Decimate, with an arithmetic shift for signed sums
+				if (adc_os_signed)
+				{
+					adc_os_result = (int16_t) adc_os_sum >> adc_os_bits;
+				}
+				else
+				{
+					adc_os_result = adc_os_sum >> adc_os_bits;
+				}
+				ADCSRA &= ~(1 << ADIE);
+				adc_mode = ADC_MODE_IDLE;
+			}
+			else
+			{
+				ADCSRA |= (1 << ADSC);
+			}
+		break;
+	}
+}
+
+
+/**
+* @brief ADC conversion complete interrupt
+*/
+ISR(ADC_vect)
+{
+	ADC_PROFILE_ISR_ENTRY(profile_start);
+	adcConversionComplete();
+	ADC_PROFILE_END(ADC_PROFILE_ISR, profile_start);
 }
\ No newline at end of file
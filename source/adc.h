@@ -16,6 +16,7 @@
 // ##### Includes #####
 #include <avr/io.h>
 #include <stdio.h>
+#include "vref.h"
 
 
 // ##### Definitions #####
@@ -81,6 +82,8 @@ enum ADC_CH {
 	ADC8 = 8,
 	ADC9 = 9,
 	ADC10 = 10,
+	/// Internal temperature sensor (only for scan tables and adcTempRead())
+	TEMP_SENSOR = 11,
 	VCC_4 = 12,
 	AMP0 = 14,
 	AMP1 = 15,
@@ -88,6 +91,41 @@ enum ADC_CH {
 	BANDGAP = 17,
 	GND = 18,		
 	};
+
+/** Maximum number of additional bits of an oversampled conversion */
+#define ADC_OVERSAMPLE_MAX_BITS 3
+
+/** Minimum number of discarded conversions after the reference bits changed between two conversions (e.g. for the temperature sensor) */
+#ifndef ADC_REF_SETTLE
+#define ADC_REF_SETTLE 2
+#endif
+
+/** CPU clock in Hz, used to convert the settling time of the reference into discarded conversions. Taken from F_CPU. */
+#if !defined(ADC_F_CPU) && defined(F_CPU)
+#define ADC_F_CPU F_CPU
+#endif
+
+/** Number of discarded conversions after the multiplexer was switched to ::BANDGAP from another channel */
+#ifndef ADC_BANDGAP_SETTLE
+#define ADC_BANDGAP_SETTLE 1
+#endif
+
+/** Number of averaged conversions of a blocking temperature measurement. Has to be a power of two. */
+#ifndef ADC_TEMP_SAMPLES
+#define ADC_TEMP_SAMPLES 64
+#endif
+
+/**
+ * Result of the blocking read functions while the conversion engine is occupied by
+ * continuous conversions or a continuous scan (outside of the range of a conversion result)
+**/
+#define ADC_BUSY 0xFFFF
+
+/** Result of adcTempRead() while the conversion engine is occupied, see ::ADC_BUSY */
+#define ADC_TEMP_BUSY (-128)
+
+/** Number of ADC input channel selections (size of channel indexed arrays) */
+#define ADC_CH_NUM 19
 	
 /**
  *
@@ -101,16 +139,324 @@ enum ADC_GAIN {
 	ADC_GAIN20 = 2,
 	ADC_GAIN40 = 3,
 	};
+
 	
+/**
+ *
+ * \enum    ADC_TRIGGER
+ *
+ * \brief   Enum class for possible ADC Auto Trigger Source Selection
+**/
+enum ADC_TRIGGER {
+	/// Free running mode
+	ADC_TRIG_FREE_RUNNING = 0,
+	/// External interrupt request 0
+	ADC_TRIG_INT0 = 1,
+	/// Timer/Counter0 compare match A
+	ADC_TRIG_TIMER0_COMPA = 2,
+	/// Timer/Counter0 overflow
+	ADC_TRIG_TIMER0_OVF = 3,
+	/// Timer/Counter1 compare match B
+	ADC_TRIG_TIMER1_COMPB = 4,
+	/// Timer/Counter1 overflow
+	ADC_TRIG_TIMER1_OVF = 5,
+	/// Timer/Counter1 capture event
+	ADC_TRIG_TIMER1_CAPT = 6,
+	/// PSC module 0 synchronization signal
+	ADC_TRIG_PSC0_SYNC = 7,
+	/// PSC module 1 synchronization signal
+	ADC_TRIG_PSC1_SYNC = 8,
+	/// PSC module 2 synchronization signal
+	ADC_TRIG_PSC2_SYNC = 9,
+	/// Analog comparator 0
+	ADC_TRIG_ACMP0 = 10,
+	/// Analog comparator 1
+	ADC_TRIG_ACMP1 = 11,
+	/// Analog comparator 2
+	ADC_TRIG_ACMP2 = 12,
+	/// Analog comparator 3
+	ADC_TRIG_ACMP3 = 13,
+	};
+
+
+/**
+ *
+ * \enum    ADC_HOOK_SLOT
+ *
+ * \brief   Enum class for the slots of the acquisition hook pipeline.
+ * The hooks are called in the order of the slots.
+**/
+enum ADC_HOOK_SLOT {
+	/// Gain/offset calibration (adc_calib.h)
+	ADC_HOOK_CALIB,
+	/// Supply voltage monitor (adc_supply.h)
+	ADC_HOOK_SUPPLY,
+	/// Streaming statistics (adc_stats.h)
+	ADC_HOOK_STATS,
+	/// Digital filter bank (adc_filter.h)
+	ADC_HOOK_FILTER,
+	/// Window watchdog (adc_window.h)
+	ADC_HOOK_WINDOW,
+	/// Burst capture (adc_capture.h)
+	ADC_HOOK_CAPTURE,
+	/// Closed-loop PI controller (adc_control.h)
+	ADC_HOOK_CONTROL,
+	/// Number of hook slots
+	ADC_HOOK_NUM
+	};
+
+/**
+ * Acquisition hook, called by the ADC interrupt for every conversion result.
+ * The returned value is passed to the next hook and to the conversion mode.
+**/
+typedef uint16_t (*ADC_HOOK)(uint8_t channel, uint16_t value);
+
+/** Completion callback of a single conversion started with adcStartCallback() */
+typedef void (*ADC_CALLBACK)(uint8_t channel, uint16_t value);
+
+
+/** Number of entries of the ADC sample queue. Has to be a power of two. */
+#ifndef ADC_QUEUE_SIZE
+#define ADC_QUEUE_SIZE 8
+#endif
+
+/**
+ *
+ * \struct  ADC_SAMPLE
+ *
+ * \brief   Structure of a sample in the ADC sample queue
+**/
+struct ADC_SAMPLE {
+	/// Converted channel according to ::ADC_CH
+	uint8_t channel;
+	/// Conversion result
+	uint16_t value;
+	};
+	
+/**
+ *
+ * \struct  ADC_SCAN_ENTRY
+ *
+ * \brief   Structure of an entry in the channel table of the scan sequencer
+**/
+struct ADC_SCAN_ENTRY {
+	/// Channel according to ::ADC_CH
+	ADC_CH channel;
+	/// Gain according to ::ADC_GAIN (only used for ::AMP0, ::AMP1 and ::AMP2)
+	ADC_GAIN gain;
+	};
+	
+
+/** Offset correction parameter for internal temperature sensor, see adcTempOffset() */
+extern int8_t temp_offset;
+
 
 // ##### Functions #####
-void adcReference(ADC_REF mode);
+uint16_t adcReference(ADC_REF mode);
 void adcInit(ADC_CLK_DIV clk_div_value);
 uint16_t adcRead(ADC_CH channel);
+bool adcRead8(ADC_CH channel, uint8_t *value);
 int16_t adcReadDiff(ADC_CH channel, ADC_GAIN gain);
 int8_t adcTempRead(void);
 void adcTempOffset(int8_t offset);
 ADC_REF adcGetReference(void);
+bool adcStart(ADC_CH channel);
+bool adcStartCallback(ADC_CH channel, ADC_CALLBACK callback);
+bool adcPoll(void);
+bool adcReady(void);
+uint16_t adcResult(void);
+uint16_t adcReadSleep(ADC_CH channel);
+uint16_t adcReadSleepAvg(ADC_CH channel, uint8_t nsamples);
+bool adcConvStart(ADC_CH channel);
+bool adcConvBusy(void);
+bool adcQueueRead(ADC_SAMPLE *sample);
+uint8_t adcQueueCount(void);
+uint8_t adcQueueOverruns(void);
+bool adcContinuousStart(ADC_CH channel, ADC_TRIGGER trigger, uint16_t *buffer, uint8_t block_size);
+bool adcContinuousStart8(ADC_CH channel, ADC_TRIGGER trigger, uint8_t *buffer, uint8_t block_size);
+void adcContinuousStop(void);
+uint16_t *adcBlockGet(void);
+uint8_t *adcBlockGet8(void);
+void adcBlockRelease(void);
+uint16_t adcBlockOverruns(void);
+bool adcScanStart(const ADC_SCAN_ENTRY *table, uint8_t count, bool continuous);
+void adcScanStop(void);
+uint8_t adcScanSequence(void);
+uint8_t adcScanSnapshot(uint16_t *values);
+bool adcOversampleStart(ADC_CH channel, uint8_t extra_bits);
+uint16_t adcOversampleResult(void);
+uint16_t adcReadOversampled(ADC_CH channel, uint8_t extra_bits);
+void adcHookSet(ADC_HOOK_SLOT slot, ADC_HOOK hook);
+void adcTimerStart(uint8_t clock_select, uint16_t top);
+void adcTimerStop(void);
+
+
+// ##### Inline conversion functions #####
+/**
+* @brief Function to sign extend a differential conversion result
+* The results of ::AMP0, ::AMP1 and ::AMP2 are 10 bit two's complement codes.
+*
+* @param value
+* Is the raw conversion result (0x000-0x3FF)
+*
+* @return Returns the signed value (-512..511)
+*/
+static inline int16_t adcDiffSigned(uint16_t value)
+{
+	return (int16_t)((value ^ 0x200) & 0x3FF) - 0x200;
+}
+
+/**
+* @brief Function to convert a conversion result of any channel to a signed value
+* Only the results of ::AMP0, ::AMP1 and ::AMP2 are sign extended.
+*
+* @param channel
+* Is the converted channel according to ::ADC_CH
+*
+* @param value
+* Is the raw conversion result
+*
+* @return Returns the signed value
+*/
+static inline int16_t adcSignedValue(uint8_t channel, uint16_t value)
+{
+	if (channel >= AMP0 && channel <= AMP2)
+	{
+		return adcDiffSigned(value);
+	}
+	return (int16_t) value;
+}
+
+
+// ##### Compile-time sample rate configuration #####
+/**
+ *
+ * \struct  AdcStaticCheck
+ *
+ * \brief   Compile-time check, only the specialization for true is defined.
+ * A false condition stops the compilation with an incomplete type error.
+**/
+template<bool CONDITION> struct AdcStaticCheck;
+template<> struct AdcStaticCheck<true> { enum { OK = 1 }; };
+
+#ifdef F_CPU
+/**
+ *
+ * \struct  AdcSampleRate
+ *
+ * \brief   Compile-time Timer/Counter1 configuration for a sample rate
+ * The smallest Timer/Counter1 prescaler which reaches the sample rate is selected.
+ * Compilation fails if the rate is out of the timer range (F_CPU/1024/65536 Hz up to F_CPU Hz)
+ * or faster than the ADC can convert with the given clock divider (13.5 ADC clocks per auto triggered conversion).
+ * F_CPU has to be defined before this header is included.
+ *
+ * @tparam RATE_HZ
+ * Is the desired sample rate in Hz
+ *
+ * @tparam CLK_DIV
+ * Is the clock divider passed to adcInit() according to ::ADC_CLK_DIV
+**/
+template<uint32_t RATE_HZ, ADC_CLK_DIV CLK_DIV>
+struct AdcSampleRate {
+	/// Timer clocks per sample at prescaler 1
+	static const uint32_t TICKS = F_CPU / (RATE_HZ ? RATE_HZ : 1);
+	/// Timer/Counter1 clock select bits
+	static const uint8_t CLOCK_SELECT = (TICKS <= 65536UL) ? 1 : (TICKS <= 8UL*65536UL) ? 2 : (TICKS <= 64UL*65536UL) ? 3 : (TICKS <= 256UL*65536UL) ? 4 : 5;
+	/// Timer/Counter1 prescaler
+	static const uint16_t PRESCALER = (CLOCK_SELECT == 1) ? 1 : (CLOCK_SELECT == 2) ? 8 : (CLOCK_SELECT == 3) ? 64 : (CLOCK_SELECT == 4) ? 256 : 1024;
+	/// Timer/Counter1 TOP value (OCR1A)
+	static const uint16_t TOP = (TICKS + PRESCALER / 2) / PRESCALER - 1;
+	
+	enum {
+		/// Sample rate is in the range of Timer/Counter1
+		RATE_CHECK = sizeof(AdcStaticCheck<(RATE_HZ > 0) && (TICKS <= 1024UL*65536UL)>),
+		/// ADC is fast enough for the sample rate
+		ADC_CHECK = sizeof(AdcStaticCheck<(RATE_HZ <= 2UL * F_CPU / (27UL * (2UL << CLK_DIV)))>)
+		};
+	};
+
+/**
+* @brief Function to start Timer/Counter1 as ADC trigger with a compile-time checked sample rate
+* Use ::ADC_TRIG_TIMER1_COMPB as trigger source of adcContinuousStart() afterwards.
+*
+* @tparam RATE_HZ
+* Is the desired sample rate in Hz
+*
+* @tparam CLK_DIV
+* Is the clock divider passed to adcInit() according to ::ADC_CLK_DIV
+*/
+template<uint32_t RATE_HZ, ADC_CLK_DIV CLK_DIV>
+inline void adcSampleRateStart(void)
+{
+	typedef AdcSampleRate<RATE_HZ, CLK_DIV> config;
+	(void) sizeof(AdcStaticCheck<(config::RATE_CHECK != 0) && (config::ADC_CHECK != 0)>);
+	adcTimerStart(config::CLOCK_SELECT, config::TOP);
+}
+#endif
+
+
+// ##### Compile-time register configuration #####
+/**
+ *
+ * \struct  AdcRefBits
+ *
+ * \brief   Compile-time register bits of a voltage reference selection
+ * The numeric values of ::ADC_REF and ::DAC_REF are identical, so the bits apply to both.
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF
+**/
+template<uint8_t REF>
+struct AdcRefBits {
+	/// REFS1:0 bits in ADMUX
+	static const uint8_t ADMUX_BITS = (REF == ADC_EXTERNAL_REF) ? 0 :
+		(REF == ADC_INTERNAL_VCC_EXT_CAP || REF == ADC_INTERNAL_VCC_REF) ? (1 << REFS0) : ((1 << REFS1)|(1 << REFS0));
+	/// AREFEN bit in ADCSRB
+	static const uint8_t ADCSRB_BITS = (REF == ADC_INTERNAL_VCC_REF || REF == ADC_INTERNAL_2V56) ? 0 : (1 << AREFEN);
+	
+	enum { REF_CHECK = sizeof(AdcStaticCheck<(REF <= ADC_INTERNAL_2V56)>) };
+	};
+
+/**
+ *
+ * \struct  AdcConfig
+ *
+ * \brief   Compile-time ADC configuration
+ * The register values are calculated by the compiler, apply() writes each register once.
+ * It replaces the calls of adcReference() and adcInit(), e.g.
+ * @code
+ * AdcConfig<ADC_INTERNAL_VCC_REF, ADC_CLK_DIV_64>::apply();
+ * @endcode
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::ADC_REF
+ *
+ * @tparam CLK_DIV
+ * Is the clock divider according to ::ADC_CLK_DIV
+**/
+template<ADC_REF REF, ADC_CLK_DIV CLK_DIV>
+struct AdcConfig {
+	/// ADMUX value: reference, right adjusted result, channel ::ADC0
+	static const uint8_t ADMUX_VALUE = AdcRefBits<REF>::ADMUX_BITS;
+	/// ADCSRB value: reference pin, no current source, no auto trigger
+	static const uint8_t ADCSRB_VALUE = AdcRefBits<REF>::ADCSRB_BITS;
+	/// ADCSRA value: ADC enabled, prescaler (ADPS = divider index + 1)
+	static const uint8_t ADCSRA_VALUE = (1 << ADEN) | (CLK_DIV + 1);
+	
+	/**
+	* @brief Function to write the configuration and do the dummy readout of adcInit()
+	*/
+	static inline void apply(void)
+	{
+		ADMUX = ADMUX_VALUE;
+		ADCSRB = ADCSRB_VALUE;
+		vref_admux = ADMUX_VALUE & VREF_ADMUX_MASK;
+		vref_mode = REF;
+		ADCSRA = ADCSRA_VALUE | (1 << ADSC);
+		while ( ADCSRA & (1 << ADSC)){}
+		(void) ADCW;
+	}
+	};
 
 
 #endif /* ADC_H_ */
\ No newline at end of file
@@ -0,0 +1,319 @@
+/**
+* @file adc_calib.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the gain/offset calibration of the ADC channels and the DAC
+*
+*/
+
+#include <avr/io.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include "adc_calib.h"
+#include "dac.h"
+
+/** Calibration table in RAM, valid after the magic is set by adcCalibReset() or adcCalibLoad() */
+static ADC_CALIB_TABLE adc_calib_table;
+
+
+/**
+* @brief Acquisition hook of the calibration
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the raw conversion result
+*
+* @return Returns the calibrated conversion result
+*/
+static uint16_t adcCalibHook(uint8_t channel, uint16_t value)
+{
+	return adcCalibApply(channel, value);
+}
+
+
+/**
+* @brief Function to apply the calibration coefficients of a channel
+* Only a multiplication and a shift are used. The result is limited to the 10 bit range.
+* For ::AMP0, ::AMP1 and ::AMP2 the raw value is treated as 10 bit two's complement
+* code and the result is returned in the same format.
+*
+* @param channel
+* Is the the ADC channel according to ::ADC_CH
+*
+* @param raw
+* Is the raw conversion result
+*
+* @return Returns the calibrated conversion result
+*/
+uint16_t adcCalibApply(uint8_t channel, uint16_t raw)
+{
+	const ADC_CALIB *calib = &adc_calib_table.adc[channel];
+	
+	if (calib->offset == 0 && calib->gain == ADC_CALIB_ONE)
+	{
+		return raw;
+	}
+	
+	if (channel >= AMP0 && channel <= AMP2)
+	{
+		int16_t value = adcDiffSigned(raw);
+		int32_t corrected = ((int32_t)(value + calib->offset) * calib->gain) >> ADC_CALIB_SHIFT;
+		
+		if (corrected < -512)
+		{
+			corrected = -512;
+		}
+		else if (corrected > 511)
+		{
+			corrected = 511;
+		}
+		return (uint16_t) corrected & 0x3FF;
+	}
+	else
+	{
+		int32_t corrected = ((int32_t)((int16_t) raw + calib->offset) * calib->gain) >> ADC_CALIB_SHIFT;
+		
+		if (corrected < 0)
+		{
+			corrected = 0;
+		}
+		else if (corrected > 1023)
+		{
+			corrected = 1023;
+		}
+		return (uint16_t) corrected;
+	}
+}
+
+
+/**
+* @brief Function to install the calibration hook if any channel is calibrated
+*/
+static void adcCalibUpdateHook(void)
+{
+	for (uint8_t i = 0; i < ADC_CH_NUM; i++)
+	{
+		if (adc_calib_table.adc[i].offset != 0 || adc_calib_table.adc[i].gain != ADC_CALIB_ONE)
+		{
+			adcHookSet(ADC_HOOK_CALIB, adcCalibHook);
+			return;
+		}
+	}
+	adcHookSet(ADC_HOOK_CALIB, NULL);
+}
+
+
+/**
+* @brief Function to apply the DAC and temperature sensor entries of the table
+*/
+static void adcCalibUpdateOthers(void)
+{
+	dacCalibSet(adc_calib_table.dac.offset, adc_calib_table.dac.gain);
+	adcTempOffset(adc_calib_table.temp_offset);
+}
+
+
+/**
+* @brief Function to initialize the table on first use without changing the DAC and temperature sensor settings
+*/
+static void adcCalibInit(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (uint8_t i = 0; i < ADC_CH_NUM; i++)
+		{
+			adc_calib_table.adc[i].offset = 0;
+			adc_calib_table.adc[i].gain = ADC_CALIB_ONE;
+		}
+		dacCalibGet(&adc_calib_table.dac.offset, &adc_calib_table.dac.gain);
+		adc_calib_table.temp_offset = temp_offset;
+		adc_calib_table.magic = ADC_CALIB_MAGIC;
+	}
+}
+
+
+/**
+* @brief Function to reset all calibration coefficients to offset 0 and gain 1
+*/
+void adcCalibReset(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_calib_table.magic = ADC_CALIB_MAGIC;
+		for (uint8_t i = 0; i < ADC_CH_NUM; i++)
+		{
+			adc_calib_table.adc[i].offset = 0;
+			adc_calib_table.adc[i].gain = ADC_CALIB_ONE;
+		}
+		adc_calib_table.dac.offset = 0;
+		adc_calib_table.dac.gain = ADC_CALIB_ONE;
+		adc_calib_table.temp_offset = 0;
+	}
+	adcCalibUpdateHook();
+	adcCalibUpdateOthers();
+}
+
+
+/**
+* @brief Function to load the calibration table from the EEPROM
+* The table is read in one block. If the EEPROM does not hold a valid table,
+* the coefficients are reset. The DAC coefficients and the temperature sensor offset
+* of the table are applied with dacCalibSet() and adcTempOffset().
+* Call it on startup, e.g. with the address of an EEMEM ::ADC_CALIB_TABLE variable.
+*
+* @param eeprom_addr
+* Is the EEPROM address of the ::ADC_CALIB_TABLE
+*
+* @return Returns true if a valid table was loaded
+*/
+bool adcCalibLoad(const void *eeprom_addr)
+{
+	bool valid;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		eeprom_read_block(&adc_calib_table, eeprom_addr, sizeof(adc_calib_table));
+		valid = (adc_calib_table.magic == ADC_CALIB_MAGIC);
+	}
+	
+	if (!valid)
+	{
+		adcCalibReset();
+		return false;
+	}
+	adcCalibUpdateHook();
+	adcCalibUpdateOthers();
+	return true;
+}
+
+
+/**
+* @brief Function to store the calibration table in the EEPROM
+* Only changed bytes are written.
+*
+* @param eeprom_addr
+* Is the EEPROM address of the ::ADC_CALIB_TABLE
+*/
+void adcCalibSave(void *eeprom_addr)
+{
+	ADC_CALIB dac;
+	
+	if (adc_calib_table.magic != ADC_CALIB_MAGIC)
+	{
+		adcCalibInit();
+	}
+	
+	// Collect entries which are kept by other modules
+	dacCalibGet(&dac.offset, &dac.gain);
+	adc_calib_table.dac = dac;
+	adc_calib_table.temp_offset = temp_offset;
+	adc_calib_table.magic = ADC_CALIB_MAGIC;
+	
+	eeprom_update_block(&adc_calib_table, eeprom_addr, sizeof(adc_calib_table));
+}
+
+
+/**
+* @brief Function to set the calibration coefficients of an ADC channel
+*
+* @param channel
+* Is the the ADC channel according to ::ADC_CH
+*
+* @param offset
+* Is the offset in LSB, added before the gain
+*
+* @param gain
+* Is the gain with ::ADC_CALIB_SHIFT fractional bits, ::ADC_CALIB_ONE for 1.0
+*/
+void adcCalibSet(ADC_CH channel, int16_t offset, uint16_t gain)
+{
+	// Initialize the other channels on first use
+	if (adc_calib_table.magic != ADC_CALIB_MAGIC)
+	{
+		adcCalibInit();
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_calib_table.adc[channel].offset = offset;
+		adc_calib_table.adc[channel].gain = gain;
+	}
+	adcCalibUpdateHook();
+}
+
+
+/**
+* @brief Function to read the calibration coefficients of an ADC channel
+*
+* @param channel
+* Is the the ADC channel according to ::ADC_CH
+*
+* @param calib
+* Is the destination of the coefficients according to ::ADC_CALIB
+*/
+void adcCalibGet(ADC_CH channel, ADC_CALIB *calib)
+{
+	if (adc_calib_table.magic != ADC_CALIB_MAGIC)
+	{
+		calib->offset = 0;
+		calib->gain = ADC_CALIB_ONE;
+		return;
+	}
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*calib = adc_calib_table.adc[channel];
+	}
+}
+
+
+/**
+* @brief Function to calculate calibration coefficients from two known points
+* The coefficients map raw1 to ref1 and raw2 to ref2. For an ADC channel raw is the
+* conversion result of a known input and ref the ideal result of that input.
+* For the DAC raw is the measured output in ideal DAC codes and ref the written code.
+* The division is only done here, not when the coefficients are applied.
+*
+* @param raw1
+* Is the raw value of the first point
+*
+* @param ref1
+* Is the reference value of the first point
+*
+* @param raw2
+* Is the raw value of the second point
+*
+* @param ref2
+* Is the reference value of the second point
+*
+* @param calib
+* Is the destination of the coefficients according to ::ADC_CALIB
+*
+* @return Returns false if the points do not result in a gain between 0 and 4
+*/
+bool adcCalibTwoPoint(int16_t raw1, int16_t ref1, int16_t raw2, int16_t ref2, ADC_CALIB *calib)
+{
+	int16_t raw_span = raw2 - raw1;
+	int16_t ref_span = ref2 - ref1;
+	
+	if (raw_span == 0)
+	{
+		return false;
+	}
+	
+	// gain = ref_span / raw_span with ADC_CALIB_SHIFT fractional bits, rounded
+	int32_t gain = (((int32_t) ref_span << ADC_CALIB_SHIFT) + raw_span / 2) / raw_span;
+	if (gain <= 0 || gain > 0xFFFF)
+	{
+		return false;
+	}
+	
+	// offset = ref1 / gain - raw1, rounded
+	int32_t offset = (((int32_t) ref1 << ADC_CALIB_SHIFT) + gain / 2) / gain - raw1;
+	
+	calib->gain = (uint16_t) gain;
+	calib->offset = (int16_t) offset;
+	return true;
+}
@@ -0,0 +1,71 @@
+/**
+* @file adc_calib.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the ADC/DAC calibration store
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_CALIB_H_
+#define ADC_CALIB_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** Number of fractional bits of the calibration gain */
+#define ADC_CALIB_SHIFT 14
+/** Calibration gain of 1.0 */
+#define ADC_CALIB_ONE (1U << ADC_CALIB_SHIFT)
+/** Marker of a valid calibration table in the EEPROM */
+#define ADC_CALIB_MAGIC 0xCA1B
+
+/**
+ *
+ * \struct  ADC_CALIB
+ *
+ * \brief   Calibration coefficients of a channel: corrected = ((raw + offset) * gain) >> ::ADC_CALIB_SHIFT
+**/
+struct ADC_CALIB {
+	/// Offset in LSB, added before the gain
+	int16_t offset;
+	/// Gain with ::ADC_CALIB_SHIFT fractional bits (Q2.14)
+	uint16_t gain;
+	};
+
+/**
+ *
+ * \struct  ADC_CALIB_TABLE
+ *
+ * \brief   Calibration table as stored in the EEPROM
+**/
+struct ADC_CALIB_TABLE {
+	/// ::ADC_CALIB_MAGIC if the table is valid
+	uint16_t magic;
+	/// Coefficients of each ADC channel, indexed by ::ADC_CH
+	ADC_CALIB adc[ADC_CH_NUM];
+	/// Coefficients of the DAC
+	ADC_CALIB dac;
+	/// Offset correction of the temperature sensor in degC, see adcTempOffset()
+	int8_t temp_offset;
+	};
+
+
+// ##### Functions #####
+void adcCalibReset(void);
+bool adcCalibLoad(const void *eeprom_addr);
+void adcCalibSave(void *eeprom_addr);
+void adcCalibSet(ADC_CH channel, int16_t offset, uint16_t gain);
+void adcCalibGet(ADC_CH channel, ADC_CALIB *calib);
+bool adcCalibTwoPoint(int16_t raw1, int16_t ref1, int16_t raw2, int16_t ref2, ADC_CALIB *calib);
+uint16_t adcCalibApply(uint8_t channel, uint16_t raw);
+
+
+#endif /* ADC_CALIB_H_ */
@@ -0,0 +1,71 @@
+/**
+* @file adc_capture.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the burst capture with pre-trigger
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_CAPTURE_H_
+#define ADC_CAPTURE_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** First sync byte of a binary capture dump */
+#define ADC_CAPTURE_SYNC0 0xA5
+/** Second sync byte of a binary capture dump */
+#define ADC_CAPTURE_SYNC1 0x5A
+
+/**
+ *
+ * \enum    ADC_CAPTURE_TRIGGER
+ *
+ * \brief   Enum class for the trigger condition of a burst capture
+**/
+enum ADC_CAPTURE_TRIGGER {
+	/// Value rises to or above the trigger level
+	ADC_CAPTURE_RISING,
+	/// Value falls to or below the trigger level
+	ADC_CAPTURE_FALLING,
+	/// adcCaptureTrigger() is called (e.g. by an external interrupt)
+	ADC_CAPTURE_EXTERNAL,
+	};
+
+/**
+ *
+ * \enum    ADC_CAPTURE_STATE
+ *
+ * \brief   Enum class for the state of a burst capture
+**/
+enum ADC_CAPTURE_STATE {
+	/// No capture armed
+	ADC_CAPTURE_IDLE,
+	/// Recording pre-trigger samples and waiting for the trigger
+	ADC_CAPTURE_ARMED,
+	/// Trigger occurred, recording post-trigger samples
+	ADC_CAPTURE_TRIGGERED,
+	/// Buffer is frozen and can be read
+	ADC_CAPTURE_DONE,
+	};
+
+
+// ##### Functions #####
+bool adcCaptureStart(ADC_CH channel, uint16_t *buffer, uint16_t size, uint16_t post_trigger, ADC_CAPTURE_TRIGGER trigger, int16_t level);
+bool adcCaptureStart8(ADC_CH channel, uint8_t *buffer, uint16_t size, uint16_t post_trigger, ADC_CAPTURE_TRIGGER trigger, uint8_t level);
+void adcCaptureTrigger(void);
+void adcCaptureStop(void);
+ADC_CAPTURE_STATE adcCaptureState(void);
+uint16_t adcCaptureRead(uint16_t index);
+void adcCaptureDump(void);
+
+
+#endif /* ADC_CAPTURE_H_ */
@@ -0,0 +1,187 @@
+/**
+* @file adc_control.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the PI controller running in the ADC acquisition hook
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "adc_control.h"
+
+/** Upper limit of the integrator (DAC full scale with ADC_CONTROL_SHIFT fractional bits) */
+#define ADC_CONTROL_INTEGRAL_MAX (1023L << ADC_CONTROL_SHIFT)
+
+/** Controlled input channel */
+static uint8_t adc_control_channel = 0;
+/** Setpoint in ADC codes */
+static int16_t adc_control_setpoint = 0;
+/** Proportional gain with ADC_CONTROL_SHIFT fractional bits */
+static int16_t adc_control_kp = 0;
+/** Integral gain per sample with ADC_CONTROL_SHIFT fractional bits */
+static int16_t adc_control_ki = 0;
+/** Integrator with ADC_CONTROL_SHIFT fractional bits */
+static int32_t adc_control_integral = 0;
+/** Last output value */
+static volatile uint16_t adc_control_output = 0;
+
+
+/**
+* @brief Acquisition hook of the PI controller
+* The integrator is limited to the DAC range (anti-windup), the output is limited
+* to 0..1023 and written with dacWriteFast() in the same interrupt.
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcControlHook(uint8_t channel, uint16_t value)
+{
+	if (channel != adc_control_channel) return value;
+	
+	int16_t sample = adcSignedValue(channel, value);
+	
+	int16_t error = adc_control_setpoint - sample;
+	
+	// Integral part with anti-windup
+	int32_t integral = adc_control_integral + (int32_t) adc_control_ki * error;
+	if (integral < 0)
+	{
+		integral = 0;
+	}
+	else if (integral > ADC_CONTROL_INTEGRAL_MAX)
+	{
+		integral = ADC_CONTROL_INTEGRAL_MAX;
+	}
+	adc_control_integral = integral;
+	
+	// Proportional part and limitation to the DAC range
+	int32_t output = (integral + (int32_t) adc_control_kp * error) >> ADC_CONTROL_SHIFT;
+	if (output < 0)
+	{
+		output = 0;
+	}
+	else if (output > 1023)
+	{
+		output = 1023;
+	}
+	
+	adc_control_output = output;
+	dacWriteFast(output);
+	return value;
+}
+
+
+/**
+* @brief Function to start the PI controller
+* Every conversion of the channel runs one controller step and writes the DAC, so the
+* loop runs at the sample rate of the acquisition with a latency of one conversion, e.g.
+* @code
+* adcControlStart(ADC2, 512, ADC_CONTROL_ONE / 2, ADC_CONTROL_ONE / 16, 0);
+* adcSampleRateStart<2000, ADC_CLK_DIV_64>();
+* adcContinuousStart(ADC2, ADC_TRIG_TIMER1_COMPB, NULL, 0);
+* sei();
+* @endcode
+* With a single ended input a positive gain increases the output while the input is below
+* the setpoint, use negative gains for an inverting plant.
+*
+* @param channel
+* Is the the controlled ADC channel according to ::ADC_CH
+*
+* @param setpoint
+* Is the setpoint in ADC codes (signed for ::AMP0, ::AMP1 and ::AMP2)
+*
+* @param kp
+* Is the proportional gain with ::ADC_CONTROL_SHIFT fractional bits
+*
+* @param ki
+* Is the integral gain per sample with ::ADC_CONTROL_SHIFT fractional bits
+*
+* @param output
+* Is the initial output (0-1023), the integrator starts with it for a bumpless start
+*
+* @return Returns false if the initial output is out of the DAC range
+*/
+bool adcControlStart(ADC_CH channel, int16_t setpoint, int16_t kp, int16_t ki, uint16_t output)
+{
+	if (output > 1023) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_control_channel = channel;
+		adc_control_setpoint = setpoint;
+		adc_control_kp = kp;
+		adc_control_ki = ki;
+		adc_control_integral = (int32_t) output << ADC_CONTROL_SHIFT;
+		adc_control_output = output;
+	}
+	dacWriteFast(output);
+	adcHookSet(ADC_HOOK_CONTROL, adcControlHook);
+	return true;
+}
+
+
+/**
+* @brief Function to stop the PI controller, the DAC keeps its last value
+*/
+void adcControlStop(void)
+{
+	adcHookSet(ADC_HOOK_CONTROL, NULL);
+}
+
+
+/**
+* @brief Function to change the setpoint of the running controller
+*
+* @param setpoint
+* Is the setpoint in ADC codes (signed for ::AMP0, ::AMP1 and ::AMP2)
+*/
+void adcControlSetpoint(int16_t setpoint)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_control_setpoint = setpoint;
+	}
+}
+
+
+/**
+* @brief Function to change the gains of the running controller
+* Both gains are changed between two controller steps.
+*
+* @param kp
+* Is the proportional gain with ::ADC_CONTROL_SHIFT fractional bits
+*
+* @param ki
+* Is the integral gain per sample with ::ADC_CONTROL_SHIFT fractional bits
+*/
+void adcControlGains(int16_t kp, int16_t ki)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_control_kp = kp;
+		adc_control_ki = ki;
+	}
+}
+
+
+/**
+* @brief Function to read the last output of the controller
+*
+* @return Returns the last value (0-1023) written to the DAC
+*/
+uint16_t adcControlOutput(void)
+{
+	uint16_t output;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		output = adc_control_output;
+	}
+	return output;
+}
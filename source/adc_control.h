@@ -0,0 +1,38 @@
+/**
+* @file adc_control.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the closed-loop ADC to DAC PI controller
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_CONTROL_H_
+#define ADC_CONTROL_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+#include "dac.h"
+
+
+// ##### Definitions #####
+/** Number of fractional bits of the controller gains */
+#define ADC_CONTROL_SHIFT 8
+/** Gain of 1.0 */
+#define ADC_CONTROL_ONE (1 << ADC_CONTROL_SHIFT)
+
+
+// ##### Functions #####
+bool adcControlStart(ADC_CH channel, int16_t setpoint, int16_t kp, int16_t ki, uint16_t output);
+void adcControlStop(void);
+void adcControlSetpoint(int16_t setpoint);
+void adcControlGains(int16_t kp, int16_t ki);
+uint16_t adcControlOutput(void);
+
+
+#endif /* ADC_CONTROL_H_ */
@@ -0,0 +1,213 @@
+/**
+* @file adc_filter.h
+* @author Christoph Jurczyk
+* @date December 07, 2018
+* @brief Header file for the fixed-point ADC filter bank
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_FILTER_H_
+#define ADC_FILTER_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/**
+ *
+ * \class   AdcFilter
+ *
+ * \brief   Base class of the filters in the filter bank.
+ * A filter is attached to a channel with adcFilterAttach() and updated by the
+ * ADC interrupt with every conversion result of that channel.
+ * The results of ::AMP0, ::AMP1 and ::AMP2 are sign extended before filtering,
+ * so the filtered value read with value() is signed for these channels.
+**/
+class AdcFilter {
+public:
+	AdcFilter(ADC_CH channel);
+	int16_t value(void);
+	virtual void update(int16_t sample);
+	
+	/// Filtered channel according to ::ADC_CH
+	uint8_t channel;
+	/// Next filter in the filter bank
+	AdcFilter *next;
+	
+protected:
+	/// Filtered value
+	volatile int16_t output;
+	/// Filter state is initialized with a first sample
+	bool primed;
+	};
+
+/**
+ *
+ * \struct  AdcLog2
+ *
+ * \brief   Compile-time base 2 logarithm of a power of two
+**/
+template<uint8_t N> struct AdcLog2 { enum { VALUE = 1 + AdcLog2<N / 2>::VALUE }; };
+template<> struct AdcLog2<1> { enum { VALUE = 0 }; };
+
+
+/**
+ *
+ * \class   AdcIirFilter
+ *
+ * \brief   Exponential IIR filter: y += (x - y) / 2^SHIFT
+ * The state is kept with SHIFT fractional bits, so no precision is lost.
+ *
+ * @tparam SHIFT
+ * Is the filter coefficient as power of two (1 to 6)
+**/
+template<uint8_t SHIFT>
+class AdcIirFilter : public AdcFilter {
+public:
+	enum { SHIFT_CHECK = sizeof(AdcStaticCheck<(SHIFT >= 1) && (SHIFT <= 6)>) };
+	
+	AdcIirFilter(ADC_CH channel) : AdcFilter(channel), state(0) {}
+	
+	virtual void update(int16_t sample)
+	{
+		if (!primed)
+		{
+			state = (int32_t) sample << SHIFT;
+			primed = true;
+		}
+		else
+		{
+			state = state - (state >> SHIFT) + sample;
+		}
+		output = state >> SHIFT;
+	}
+	
+private:
+	/// Filtered value with SHIFT fractional bits
+	int32_t state;
+	};
+
+
+/**
+ *
+ * \class   AdcMovingAverage
+ *
+ * \brief   Boxcar moving average over the last N samples with running sum
+ *
+ * @tparam N
+ * Is the window length as power of two (2 to 64)
+**/
+template<uint8_t N>
+class AdcMovingAverage : public AdcFilter {
+public:
+	enum { N_CHECK = sizeof(AdcStaticCheck<(N >= 2) && (N <= 64) && ((N & (N - 1)) == 0)>) };
+	
+	AdcMovingAverage(ADC_CH channel) : AdcFilter(channel), sum(0), index(0) {}
+	
+	virtual void update(int16_t sample)
+	{
+		if (!primed)
+		{
+			// Fill window with first sample
+			for (uint8_t i = 0; i < N; i++)
+			{
+				window[i] = sample;
+			}
+			sum = (int32_t) sample << AdcLog2<N>::VALUE;
+			primed = true;
+		}
+		else
+		{
+			sum = sum - window[index] + sample;
+			window[index] = sample;
+		}
+		index = (index + 1) & (N - 1);
+		output = sum >> AdcLog2<N>::VALUE;
+	}
+	
+private:
+	/// Last N samples
+	int16_t window[N];
+	/// Sum of the window
+	int32_t sum;
+	/// Position of the oldest sample
+	uint8_t index;
+	};
+
+
+/**
+ *
+ * \class   AdcMedianFilter
+ *
+ * \brief   Median of the last N samples to reject single spikes
+ *
+ * @tparam N
+ * Is the odd window length (3 to 7)
+**/
+template<uint8_t N>
+class AdcMedianFilter : public AdcFilter {
+public:
+	enum { N_CHECK = sizeof(AdcStaticCheck<(N >= 3) && (N <= 7) && (N & 1)>) };
+	
+	AdcMedianFilter(ADC_CH channel) : AdcFilter(channel), index(0) {}
+	
+	virtual void update(int16_t sample)
+	{
+		if (!primed)
+		{
+			for (uint8_t i = 0; i < N; i++)
+			{
+				window[i] = sample;
+			}
+			primed = true;
+		}
+		window[index] = sample;
+		if (++index >= N)
+		{
+			index = 0;
+		}
+		
+		// Count for each sample how many samples are smaller and equal
+		for (uint8_t i = 0; i < N; i++)
+		{
+			uint8_t below = 0;
+			uint8_t equal = 0;
+			for (uint8_t j = 0; j < N; j++)
+			{
+				if (window[j] < window[i])
+				{
+					below++;
+				}
+				else if (window[j] == window[i])
+				{
+					equal++;
+				}
+			}
+			if (below <= N / 2 && below + equal > N / 2)
+			{
+				output = window[i];
+				break;
+			}
+		}
+	}
+	
+private:
+	/// Last N samples
+	int16_t window[N];
+	/// Position of the oldest sample
+	uint8_t index;
+	};
+
+
+// ##### Functions #####
+void adcFilterAttach(AdcFilter *filter);
+void adcFilterDetach(AdcFilter *filter);
+
+
+#endif /* ADC_FILTER_H_ */
@@ -0,0 +1,261 @@
+/**
+* @file adc_profile.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the latency and throughput instrumentation of the ADC driver
+*
+*/
+
+#include <avr/io.h>
+#include <util/atomic.h>
+#include "adc_profile.h"
+
+#ifdef ADC_PROFILE
+
+/** Latency statistics of the sections */
+static ADC_PROFILE_STAT adc_profile_stats[ADC_PROFILE_POINT_NUM];
+/** Time stamp of the last software conversion start */
+static volatile uint16_t adc_profile_conv_start;
+/** A software conversion start is pending */
+static volatile bool adc_profile_conv_pending = false;
+/** Time stamp of the last ADC interrupt */
+static uint16_t adc_profile_last_isr;
+/** The time stamp of the last ADC interrupt is valid */
+static bool adc_profile_last_valid = false;
+/** Number of measured ADC interrupt periods */
+static volatile uint32_t adc_profile_periods = 0;
+/** Sum of the ADC interrupt periods in ticks */
+static volatile uint32_t adc_profile_period_sum = 0;
+
+
+/**
+* @brief Function to calculate the ticks between a time stamp and now
+* In CTC mode (adcTimerStart()) the counter wraps at OCR1A, otherwise at 0xFFFF.
+* Sections longer than one timer period are not measured correctly.
+*
+* @param start
+* Is the time stamp of the start
+*
+* @param now
+* Is the current time stamp
+*
+* @return Returns the elapsed ticks
+*/
+static uint16_t adcProfileElapsed(uint16_t start, uint16_t now)
+{
+	if (now < start && (TCCR1B & (1 << WGM12)))
+	{
+		return now + (OCR1A + 1) - start;
+	}
+	return now - start;
+}
+
+
+/**
+* @brief Function to add a measurement to the statistics of a section
+*
+* @param point
+* Is the section according to ::ADC_PROFILE_POINT
+*
+* @param ticks
+* Is the measured latency
+*/
+static void adcProfileAdd(ADC_PROFILE_POINT point, uint16_t ticks)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		ADC_PROFILE_STAT *stat = &adc_profile_stats[point];
+		
+		if (stat->count == 0xFFFF) break;
+		if (stat->count == 0 || ticks < stat->min) stat->min = ticks;
+		if (ticks > stat->max) stat->max = ticks;
+		stat->sum += ticks;
+		stat->count++;
+	}
+}
+
+
+/**
+* @brief Function to initialize the time base of the instrumentation
+* If Timer/Counter1 is stopped, it is started in normal mode with the given clock select.
+* A running timer (e.g. the ADC trigger of adcTimerStart()) is used as it is.
+*
+* @param clock_select
+* Is the Timer/Counter1 clock select value (CS12:0), e.g. 2 for F_CPU/8
+*/
+void adcProfileInit(uint8_t clock_select)
+{
+	if ((TCCR1B & 0x07) == 0)
+	{
+		TCCR1A = 0;
+		TCCR1B = clock_select & 0x07;
+	}
+	adcProfileReset();
+}
+
+
+/**
+* @brief Function to reset all measurements
+*/
+void adcProfileReset(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		for (uint8_t i = 0; i < ADC_PROFILE_POINT_NUM; i++)
+		{
+			adc_profile_stats[i].count = 0;
+			adc_profile_stats[i].min = 0;
+			adc_profile_stats[i].max = 0;
+			adc_profile_stats[i].sum = 0;
+		}
+		adc_profile_conv_pending = false;
+		adc_profile_last_valid = false;
+		adc_profile_periods = 0;
+		adc_profile_period_sum = 0;
+	}
+}
+
+
+/**
+* @brief Function to read the time stamp
+*
+* @return Returns the value of Timer/Counter1
+*/
+uint16_t adcProfileTime(void)
+{
+	uint16_t time;
+	
+	// 16 bit timer access uses the shared TEMP register
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		time = TCNT1;
+	}
+	return time;
+}
+
+
+/**
+* @brief Function to end the measurement of a section
+*
+* @param point
+* Is the section according to ::ADC_PROFILE_POINT
+*
+* @param start
+* Is the time stamp of the start of the section
+*/
+void adcProfileRecord(ADC_PROFILE_POINT point, uint16_t start)
+{
+	adcProfileAdd(point, adcProfileElapsed(start, adcProfileTime()));
+}
+
+
+/**
+* @brief Function to mark the software start of a conversion
+*/
+void adcProfileConvStart(void)
+{
+	adc_profile_conv_start = adcProfileTime();
+	adc_profile_conv_pending = true;
+}
+
+
+/**
+* @brief Function to mark the entry of the ADC interrupt
+* Records the conversion latency of a software started conversion and the
+* period since the last interrupt for the sample rate.
+*
+* @return Returns the time stamp of the entry
+*/
+uint16_t adcProfileIsrEntry(void)
+{
+	uint16_t now = adcProfileTime();
+	
+	if (adc_profile_conv_pending)
+	{
+		adc_profile_conv_pending = false;
+		adcProfileAdd(ADC_PROFILE_CONVERSION, adcProfileElapsed(adc_profile_conv_start, now));
+	}
+	
+	if (adc_profile_last_valid)
+	{
+		adc_profile_period_sum += adcProfileElapsed(adc_profile_last_isr, now);
+		adc_profile_periods++;
+	}
+	adc_profile_last_isr = now;
+	adc_profile_last_valid = true;
+	
+	return now;
+}
+
+
+/**
+* @brief Function to read the statistics of a section
+*
+* @param point
+* Is the section according to ::ADC_PROFILE_POINT
+*
+* @param stat
+* Is the destination of the statistics
+*
+* @return Returns false if the section is invalid
+*/
+bool adcProfileGet(ADC_PROFILE_POINT point, ADC_PROFILE_STAT *stat)
+{
+	if (point >= ADC_PROFILE_POINT_NUM) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		*stat = adc_profile_stats[point];
+	}
+	return true;
+}
+
+
+/**
+* @brief Function to calculate the achieved sample rate
+* The rate is measured from the periods between ADC interrupts, so pauses between
+* blocking reads are included.
+*
+* @param timer_hz
+* Is the clock of Timer/Counter1 (F_CPU / prescaler)
+*
+* @return Returns the samples per second or 0 if not measured
+*/
+uint32_t adcProfileRate(uint32_t timer_hz)
+{
+	uint32_t periods;
+	uint32_t sum;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		periods = adc_profile_periods;
+		sum = adc_profile_period_sum;
+	}
+	
+	if (sum == 0) return 0;
+	return (uint64_t) periods * timer_hz / sum;
+}
+
+
+/**
+* @brief Function to print all measurements to stdout (e.g. the UART stream)
+*
+* @param timer_hz
+* Is the clock of Timer/Counter1 (F_CPU / prescaler)
+*/
+void adcProfileDump(uint32_t timer_hz)
+{
+	static const char * const names[ADC_PROFILE_POINT_NUM] = { "conversion", "isr", "adcRead", "adcReadDiff", "adcTempRead" };
+	
+	for (uint8_t i = 0; i < ADC_PROFILE_POINT_NUM; i++)
+	{
+		ADC_PROFILE_STAT stat;
+		
+		adcProfileGet((ADC_PROFILE_POINT) i, &stat);
+		printf("%s: n=%u min=%u max=%u avg=%lu ticks\n", names[i], stat.count, stat.min, stat.max,
+			(unsigned long)(stat.count ? stat.sum / stat.count : 0));
+	}
+	printf("rate=%lu samples/s\n", (unsigned long) adcProfileRate(timer_hz));
+}
+
+#endif
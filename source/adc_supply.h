@@ -0,0 +1,43 @@
+/**
+* @file adc_supply.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the supply voltage monitor
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_SUPPLY_H_
+#define ADC_SUPPLY_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** Voltage of the internal bandgap reference in mV */
+#ifndef ADC_BANDGAP_MV
+#define ADC_BANDGAP_MV 1100
+#endif
+
+/** Supply voltage in mV assumed until the bandgap was measured */
+#ifndef ADC_SUPPLY_DEFAULT_MV
+#define ADC_SUPPLY_DEFAULT_MV 5000
+#endif
+
+
+// ##### Functions #####
+void adcSupplyEnable(void);
+bool adcSupplyMeasure(void);
+uint8_t adcSupplySequence(void);
+uint16_t adcSupplyMillivolts(void);
+uint16_t adcSupplyToMillivolts(uint16_t value);
+uint16_t adcReadMillivolts(ADC_CH channel);
+
+
+#endif /* ADC_SUPPLY_H_ */
@@ -0,0 +1,255 @@
+/**
+* @file adc_window.cpp
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief This file contains the analog window watchdog evaluated in the ADC interrupt
+*
+*/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+#include "adc_window.h"
+
+/** Channel value of a disabled window */
+#define ADC_WINDOW_OFF 0xFF
+
+/**
+ *
+ * \struct  ADC_WINDOW
+ *
+ * \brief   Structure of a watchdog window
+**/
+struct ADC_WINDOW {
+	/// Monitored channel according to ::ADC_CH, ::ADC_WINDOW_OFF if disabled
+	uint8_t channel;
+	/// State according to ::ADC_WINDOW_STATE
+	uint8_t state;
+	/// Low threshold
+	int16_t low;
+	/// High threshold
+	int16_t high;
+	/// Hysteresis for leaving the below/above state
+	uint16_t hysteresis;
+	};
+
+/** Watchdog windows */
+static ADC_WINDOW adc_windows[ADC_WINDOW_NUM];
+/** Number of the highest enabled window + 1 */
+static volatile uint8_t adc_window_count = 0;
+/** Event flags, one bit per window */
+static volatile uint8_t adc_window_events = 0;
+/** Callback of a window crossing */
+static volatile ADC_WINDOW_CALLBACK adc_window_callback = NULL;
+
+
+/**
+* @brief Acquisition hook of the window watchdog
+* The state only changes if the value crosses a threshold, the way back into the window
+* needs the hysteresis in addition.
+*
+* @param channel
+* Is the converted channel
+*
+* @param value
+* Is the conversion result
+*
+* @return Returns the unchanged conversion result
+*/
+static uint16_t adcWindowHook(uint8_t channel, uint16_t value)
+{
+	int16_t sample = adcSignedValue(channel, value);
+	
+	for (uint8_t i = 0; i < adc_window_count; i++)
+	{
+		ADC_WINDOW *window = &adc_windows[i];
+		
+		if (window->channel != channel) continue;
+		
+		uint8_t state = window->state;
+		
+		if (state == ADC_WINDOW_ABOVE && sample < window->high - (int16_t) window->hysteresis)
+		{
+			state = ADC_WINDOW_INSIDE;
+		}
+		else if (state == ADC_WINDOW_BELOW && sample > window->low + (int16_t) window->hysteresis)
+		{
+			state = ADC_WINDOW_INSIDE;
+		}
+		
+		if (sample > window->high)
+		{
+			state = ADC_WINDOW_ABOVE;
+		}
+		else if (sample < window->low)
+		{
+			state = ADC_WINDOW_BELOW;
+		}
+		
+		if (state != window->state)
+		{
+			window->state = state;
+			adc_window_events |= (1 << i);
+			
+			ADC_WINDOW_CALLBACK callback = adc_window_callback;
+			if (callback != NULL)
+			{
+				callback(i, (ADC_WINDOW_STATE) state, sample);
+			}
+		}
+	}
+	return value;
+}
+
+
+/**
+* @brief Function to configure a watchdog window
+* The window is evaluated for every conversion of the channel, no matter which
+* conversion mode (scan, continuous, single) produced it. A crossing sets the event
+* flag of the window and calls the callback. The window starts in ::ADC_WINDOW_INSIDE.
+*
+* @param window
+* Is the number of the window (0..ADC_WINDOW_NUM-1)
+*
+* @param channel
+* Is the the monitored ADC channel according to ::ADC_CH
+*
+* @param low
+* Is the low threshold (signed for ::AMP0, ::AMP1 and ::AMP2)
+*
+* @param high
+* Is the high threshold (signed for ::AMP0, ::AMP1 and ::AMP2)
+*
+* @param hysteresis
+* Is the distance a value has to get back into the window to leave the below/above state
+*
+* @return Returns false if the window number or the thresholds are invalid
+*/
+bool adcWindowSet(uint8_t window, ADC_CH channel, int16_t low, int16_t high, uint16_t hysteresis)
+{
+	if (window >= ADC_WINDOW_NUM || low > high) return false;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_windows[window].channel = channel;
+		adc_windows[window].state = ADC_WINDOW_INSIDE;
+		adc_windows[window].low = low;
+		adc_windows[window].high = high;
+		adc_windows[window].hysteresis = hysteresis;
+		adc_window_events &= ~(1 << window);
+		
+		if (window >= adc_window_count)
+		{
+			// Disable the unused windows in between
+			for (uint8_t i = adc_window_count; i < window; i++)
+			{
+				adc_windows[i].channel = ADC_WINDOW_OFF;
+			}
+			adc_window_count = window + 1;
+		}
+	}
+	adcHookSet(ADC_HOOK_WINDOW, adcWindowHook);
+	return true;
+}
+
+
+/**
+* @brief Function to disable a watchdog window
+*
+* @param window
+* Is the number of the window (0..ADC_WINDOW_NUM-1)
+*/
+void adcWindowDisable(uint8_t window)
+{
+	if (window >= ADC_WINDOW_NUM) return;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		adc_windows[window].channel = ADC_WINDOW_OFF;
+		adc_window_events &= ~(1 << window);
+		
+		while (adc_window_count > 0 && adc_windows[adc_window_count - 1].channel == ADC_WINDOW_OFF)
+		{
+			adc_window_count--;
+		}
+	}
+	
+	if (adc_window_count == 0)
+	{
+		adcHookSet(ADC_HOOK_WINDOW, NULL);
+	}
+}
+
+
+/**
+* @brief Function to set the callback of a window crossing
+* The callback is called by the ADC interrupt and has to be short.
+*
+* @param callback
+* Is the callback or NULL
+*/
+void adcWindowCallback(ADC_WINDOW_CALLBACK callback)
+{
+	adc_window_callback = callback;
+}
+
+
+/**
+* @brief Function to read the state of a watchdog window
+*
+* @param window
+* Is the number of the window (0..ADC_WINDOW_NUM-1)
+*
+* @return Returns the state according to ::ADC_WINDOW_STATE
+*/
+ADC_WINDOW_STATE adcWindowState(uint8_t window)
+{
+	if (window >= ADC_WINDOW_NUM) return ADC_WINDOW_INSIDE;
+	return (ADC_WINDOW_STATE) adc_windows[window].state;
+}
+
+
+/**
+* @brief Function to read and clear the event flags
+*
+* @return Returns the event flags, bit n is set if window n changed its state
+*/
+uint8_t adcWindowEvents(void)
+{
+	uint8_t events;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		events = adc_window_events;
+		adc_window_events = 0;
+	}
+	return events;
+}
+
+
+/**
+* @brief Function to sleep in idle mode until a window event occurs
+* The acquisition has to run in the background (e.g. scan or continuous mode)
+* and global interrupts have to be enabled.
+*
+* @return Returns the event flags, see adcWindowEvents()
+*/
+uint8_t adcWindowWait(void)
+{
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	
+	while (1)
+	{
+		cli();
+		if (adc_window_events != 0) break;
+		
+		// sei() is executed before sleep, so no interrupt is missed
+		sleep_enable();
+		sei();
+		sleep_cpu();
+		sleep_disable();
+	}
+	sei();
+	return adcWindowEvents();
+}
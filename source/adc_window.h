@@ -0,0 +1,60 @@
+/**
+* @file adc_window.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the analog window watchdog
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef ADC_WINDOW_H_
+#define ADC_WINDOW_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <stdio.h>
+#include "adc.h"
+
+
+// ##### Definitions #####
+/** Number of watchdog windows (1..8) */
+#ifndef ADC_WINDOW_NUM
+#define ADC_WINDOW_NUM 4
+#endif
+
+#if ADC_WINDOW_NUM < 1 || ADC_WINDOW_NUM > 8
+#error "ADC_WINDOW_NUM has to be 1..8, the event flags are one bit per window"
+#endif
+
+/**
+ *
+ * \enum    ADC_WINDOW_STATE
+ *
+ * \brief   Enum class for the state of a watchdog window
+**/
+enum ADC_WINDOW_STATE {
+	/// Value is inside the window
+	ADC_WINDOW_INSIDE,
+	/// Value is below the low threshold
+	ADC_WINDOW_BELOW,
+	/// Value is above the high threshold
+	ADC_WINDOW_ABOVE,
+	};
+
+/** Callback of a window crossing, called by the ADC interrupt */
+typedef void (*ADC_WINDOW_CALLBACK)(uint8_t window, ADC_WINDOW_STATE state, int16_t value);
+
+
+// ##### Functions #####
+bool adcWindowSet(uint8_t window, ADC_CH channel, int16_t low, int16_t high, uint16_t hysteresis);
+void adcWindowDisable(uint8_t window);
+void adcWindowCallback(ADC_WINDOW_CALLBACK callback);
+ADC_WINDOW_STATE adcWindowState(uint8_t window);
+uint8_t adcWindowEvents(void);
+uint8_t adcWindowWait(void);
+
+
+#endif /* ADC_WINDOW_H_ */
@@ -8,52 +8,36 @@
 
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "dac.h"
+#include "vref.h"
+#include "adc_calib.h"
+
+/** Offset of the DAC calibration in LSB */
+static int16_t dac_calib_offset = 0;
+/** Gain of the DAC calibration with ADC_CALIB_SHIFT fractional bits */
+static uint16_t dac_calib_gain = ADC_CALIB_ONE;
+/** Update function called by the DAC timer interrupt */
+static volatile DAC_TICK dac_tick = NULL;
+/** Update rate of the DAC timer in Hz */
+static uint32_t dac_timer_rate = 0;
 
 
 /**
 * @brief Function to set the ADC/DAC voltage reference selection
 * The configuration of the voltage reference selection is applied to the ADC and DAC. 
 * Independent voltage references are not possible.
+* The register bits are only written if the selection changes, see vrefSet().
 *
 * @param mode
 * Is the the desired mode of the ADC/DAC according to ::DAC_REF
+*
+* @return Returns the time in us the output needs to settle, 0 if nothing changed
 */
-void dacReference(DAC_REF mode)
+uint16_t dacReference(DAC_REF mode)
 {
-	switch(mode)
-	{	
-		case DAC_EXTERNAL_REF:
-		ADMUX &= !((1 << REFS1)|(1 << REFS0));
-		ADCSRB &= !(1 << ISRCEN);
-		ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case DAC_INTERNAL_VCC_EXT_CAP:
-		ADMUX &= !((1 << REFS1));
-		ADMUX |= (1 << REFS0);
-		ADCSRB &= !(1 << ISRCEN);
-		ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case DAC_INTERNAL_VCC_REF:
-		ADMUX &= !((1 << REFS1));
-		ADMUX |= (1 << REFS0);
-		ADCSRB &= !(1 << ISRCEN);
-		ADCSRB &= !(1 << AREFEN);
-		break;
-		
-		case DAC_INTERAL_2V56_CAP:
-		ADMUX |= ((1 << REFS1)|(1 << REFS0));
-		ADCSRB &= !(1 << ISRCEN);
-		ADCSRB |= (1 << AREFEN);
-		break;
-		
-		case DAC_INTERNAL_2V56:
-		ADMUX |= ((1 << REFS1)|(1 << REFS0));
-		ADCSRB &= !(1 << AREFEN);
-		break;
-	}
+	return vrefSet(mode);
 }
 
 
@@ -64,56 +48,166 @@ void dacReference(DAC_REF mode)
 */
 DAC_REF dacGetReference(void)
 {
-	uint8_t ref_value = ((ADMUX & ((1 << REFS1)|(1 << REFS0))) >> REFS0); // shift REFS1/0 bits to the right
-
-	switch(ref_value)
-	{
-		case 0:
-		return DAC_EXTERNAL_REF;
-		break;
-		
-		case 1:
-		if(ADCSRB & (1 << AREFEN))
-		{
-			return DAC_INTERNAL_VCC_EXT_CAP;
-			} else {
-			return DAC_INTERNAL_VCC_REF;
-		}
-		break;
-		
-		case 3:
-		if(ADCSRB & (1 << AREFEN))
-		{
-			return DAC_INTERAL_2V56_CAP;
-			} else {
-			return DAC_INTERNAL_2V56;
-		}
-		break;
-	}
-	
-	return DAC_EXTERNAL_REF;
+	return (DAC_REF) vrefGet();
 }
 
 /**
 * @brief Function to initialize DAC
+* For a configuration known at compile time DacConfig can be used instead.
 */
 void dacInit(void)
 {
-	// Set DAC to right adjust mode
-	DACON &= ~(1 << DALA);
-	// Enable DAC and set as output
-	DACON |= ((1 << DAEN)|(1 << DAOE));
+	// Enable DAC in the adjust mode of DAC_LEFT_ADJUST and set as output
+	DACON = (1 << DAEN)|(1 << DAOE)|DAC_DACON_ADJUST;
 }
 
 /**
 * @brief Function write value to DAC
+* The calibration set with dacCalibSet() is applied with a multiplication and a shift.
 *
 * @param value 
 * Is the desired value (0-1023) of the DAC output.
 */
 void dacWrite(uint16_t value)
 {
+	// Apply calibration
+	if (dac_calib_offset != 0 || dac_calib_gain != ADC_CALIB_ONE)
+	{
+		int32_t corrected = ((int32_t)((int16_t) value + dac_calib_offset) * dac_calib_gain) >> ADC_CALIB_SHIFT;
+		
+		if (corrected < 0)
+		{
+			corrected = 0;
+		}
+		else if (corrected > 1023)
+		{
+			corrected = 1023;
+		}
+		value = (uint16_t) corrected;
+	}
+	
 	// Write value to DAC
+#if DAC_LEFT_ADJUST
+	DACL = (uint8_t)(value << 6);
+	DACH = (uint8_t)(value >> 2);
+#else
 	DACL = (uint8_t)value;
 	DACH = (uint8_t)((value >> 8) & 0x03);
-}
\ No newline at end of file
+#endif
+}
+
+
+/**
+* @brief Function to set the calibration coefficients of the DAC
+* The written value is corrected to ((value + offset) * gain) >> ::ADC_CALIB_SHIFT.
+* Use adcCalibTwoPoint() to calculate the coefficients.
+*
+* @param offset
+* Is the offset in LSB, added before the gain
+*
+* @param gain
+* Is the gain with ::ADC_CALIB_SHIFT fractional bits, ::ADC_CALIB_ONE for 1.0
+*/
+void dacCalibSet(int16_t offset, uint16_t gain)
+{
+	dac_calib_offset = offset;
+	dac_calib_gain = gain;
+}
+
+
+/**
+* @brief Function to read the calibration coefficients of the DAC
+*
+* @param offset
+* Is the destination of the offset
+*
+* @param gain
+* Is the destination of the gain
+*/
+void dacCalibGet(int16_t *offset, uint16_t *gain)
+{
+	*offset = dac_calib_offset;
+	*gain = dac_calib_gain;
+}
+
+/**
+* @brief Function to start Timer/Counter0 as DAC update timer
+* Timer/Counter0 runs in CTC mode with OCR0A as TOP. The compare match A interrupt
+* calls the update function set with dacTickSet(), so all DAC engines share one timer.
+* Use dacTimerRateStart() to calculate the values from a rate at compile time.
+* Global interrupts have to be enabled with sei().
+*
+* @param clock_select
+* Is the Timer/Counter0 clock select value (CS02:0)
+*
+* @param top
+* Is the TOP value, the update period is (top+1)*prescaler/F_CPU
+*
+* @param rate_hz
+* Is the resulting update rate in Hz, see dacTimerRate()
+*/
+void dacTimerStart(uint8_t clock_select, uint8_t top, uint32_t rate_hz)
+{
+	// Stop timer
+	TCCR0B = 0;
+	dac_timer_rate = rate_hz;
+	
+	// CTC mode with OCR0A as TOP
+	TCCR0A = (1 << WGM01);
+	OCR0A = top;
+	TCNT0 = 0;
+	TIFR0 = (1 << OCF0A);
+	TIMSK0 |= (1 << OCIE0A);
+	TCCR0B = clock_select & 0x07;
+}
+
+
+/**
+* @brief Function to stop the DAC update timer
+*/
+void dacTimerStop(void)
+{
+	TCCR0B = 0;
+	TIMSK0 &= ~(1 << OCIE0A);
+}
+
+
+/**
+* @brief Function to read the update rate of the DAC timer
+*
+* @return Returns the update rate in Hz passed to dacTimerStart()
+*/
+uint32_t dacTimerRate(void)
+{
+	return dac_timer_rate;
+}
+
+
+/**
+* @brief Function to set the update function of the DAC timer interrupt
+* Only one DAC engine can drive the output at a time, setting a new function replaces the old one.
+*
+* @param tick
+* Is the update function or NULL
+*/
+void dacTickSet(DAC_TICK tick)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		dac_tick = tick;
+	}
+}
+
+
+/**
+* @brief Timer/Counter0 compare match A interrupt, DAC update timer
+*/
+ISR(TIMER0_COMPA_vect)
+{
+	DAC_TICK tick = dac_tick;
+	
+	if (tick != NULL)
+	{
+		tick();
+	}
+}
@@ -16,6 +16,7 @@
 // ##### Includes #####
 #include <avr/io.h>
 #include <stdio.h>
+#include "adc.h"
 
 
 // ##### Definitions #####
@@ -37,13 +38,162 @@ enum DAC_REF {
 	/// Internal 2.56V reference voltage
 	DAC_INTERNAL_2V56
 	};
+
+/**
+ * Update function of a DAC engine (e.g. waveform generator), called by the
+ * Timer/Counter0 compare match A interrupt at the DAC update rate.
+**/
+typedef void (*DAC_TICK)(void);
+
+/**
+ * Result adjustment of the DAC, selected at compile time for all files of the project.
+ * 0: right adjusted 10 bit values (DACL, DACH), 1: left adjusted (DALA), 8 bit writes only store DACH.
+**/
+#ifndef DAC_LEFT_ADJUST
+#define DAC_LEFT_ADJUST 0
+#endif
+
+/** DALA bit of DACON according to DAC_LEFT_ADJUST */
+#if DAC_LEFT_ADJUST
+#define DAC_DACON_ADJUST (1 << DALA)
+#else
+#define DAC_DACON_ADJUST 0
+#endif
+
+/** Minimum number of CPU cycles between two DAC timer interrupts */
+#ifndef DAC_TIMER_MIN_CYCLES
+#define DAC_TIMER_MIN_CYCLES 100
+#endif
 	
 	
 // ##### Functions #####
-void dacReference(DAC_REF mode);
+uint16_t dacReference(DAC_REF mode);
 DAC_REF dacGetReference(void);
 void dacInit(void);
 void dacWrite(uint16_t value);
+void dacCalibSet(int16_t offset, uint16_t gain);
+void dacCalibGet(int16_t *offset, uint16_t *gain);
+void dacTimerStart(uint8_t clock_select, uint8_t top, uint32_t rate_hz);
+void dacTimerStop(void);
+uint32_t dacTimerRate(void);
+void dacTickSet(DAC_TICK tick);
+
+
+// ##### Compile-time register configuration #####
+/**
+ *
+ * \struct  DacConfig
+ *
+ * \brief   Compile-time DAC configuration
+ * The register values are calculated by the compiler, apply() replaces the calls of
+ * dacReference() and dacInit(). The voltage reference is shared with the ADC and set
+ * with vrefSet(), which skips the register access if the reference does not change.
+ * @code
+ * DacConfig<DAC_INTERNAL_VCC_REF>::apply();
+ * @endcode
+ *
+ * @tparam REF
+ * Is the voltage reference selection according to ::DAC_REF
+**/
+template<DAC_REF REF>
+struct DacConfig {
+	/// DACON value: DAC and output enabled, adjustment according to DAC_LEFT_ADJUST, no auto trigger
+	static const uint8_t DACON_VALUE = (1 << DAEN)|(1 << DAOE)|DAC_DACON_ADJUST;
+	
+	/**
+	* @brief Function to write the configuration
+	*/
+	static inline void apply(void)
+	{
+		vrefSet(REF);
+		DACON = DACON_VALUE;
+	}
+	};
+
+
+// ##### Inline write functions #####
+/**
+* @brief Function to write a 10 bit value to the DAC without call overhead
+* No calibration is applied. In left adjust mode (DAC_LEFT_ADJUST) only the upper 8 bits
+* are written with a single store.
+*
+* @param value
+* Is the desired value (0-1023) of the DAC output.
+*/
+static inline void dacWriteFast(uint16_t value)
+{
+#if DAC_LEFT_ADJUST
+	DACH = (uint8_t)(value >> 2);
+#else
+	// DACH has to be written last, it updates the output
+	DACL = (uint8_t)value;
+	DACH = (uint8_t)((value >> 8) & 0x03);
+#endif
+}
+
+/**
+* @brief Function to write an 8 bit value to the DAC without call overhead
+* No calibration is applied. In left adjust mode (DAC_LEFT_ADJUST) this is a single store to DACH.
+*
+* @param value
+* Is the desired value (0-255) of the DAC output, full scale like 0-1020 of a 10 bit value.
+*/
+static inline void dacWriteFast8(uint8_t value)
+{
+#if DAC_LEFT_ADJUST
+	DACH = value;
+#else
+	dacWriteFast((uint16_t) value << 2);
+#endif
+}
+
+
+#ifdef F_CPU
+/**
+ *
+ * \struct  DacTimer
+ *
+ * \brief   Compile-time Timer/Counter0 configuration for a DAC update rate
+ * The smallest Timer/Counter0 prescaler which reaches the rate is selected.
+ * Compilation fails if the rate is out of the timer range (F_CPU/1024/256 Hz up to
+ * F_CPU/DAC_TIMER_MIN_CYCLES Hz). F_CPU has to be defined before this header is included.
+ *
+ * @tparam RATE_HZ
+ * Is the desired update rate in Hz
+**/
+template<uint32_t RATE_HZ>
+struct DacTimer {
+	/// Timer clocks per update at prescaler 1
+	static const uint32_t TICKS = F_CPU / (RATE_HZ ? RATE_HZ : 1);
+	/// Timer/Counter0 clock select bits
+	static const uint8_t CLOCK_SELECT = (TICKS <= 256UL) ? 1 : (TICKS <= 8UL*256UL) ? 2 : (TICKS <= 64UL*256UL) ? 3 : (TICKS <= 256UL*256UL) ? 4 : 5;
+	/// Timer/Counter0 prescaler
+	static const uint16_t PRESCALER = (CLOCK_SELECT == 1) ? 1 : (CLOCK_SELECT == 2) ? 8 : (CLOCK_SELECT == 3) ? 64 : (CLOCK_SELECT == 4) ? 256 : 1024;
+	/// Timer/Counter0 TOP value (OCR0A)
+	static const uint8_t TOP = (TICKS + PRESCALER / 2) / PRESCALER - 1;
+	/// Update rate reached with TOP and PRESCALER
+	static const uint32_t ACTUAL_HZ = F_CPU / ((uint32_t) PRESCALER * (TOP + 1));
+	
+	enum {
+		/// Update rate is in the range of Timer/Counter0 and leaves time for the interrupt
+		RATE_CHECK = sizeof(AdcStaticCheck<(RATE_HZ > 0) && (TICKS <= 1024UL*256UL) && (TICKS >= DAC_TIMER_MIN_CYCLES)>)
+		};
+	};
+
+/**
+* @brief Function to start Timer/Counter0 as DAC update timer with a compile-time checked rate
+*
+* @tparam RATE_HZ
+* Is the desired update rate in Hz
+*/
+template<uint32_t RATE_HZ>
+inline void dacTimerRateStart(void)
+{
+	typedef DacTimer<RATE_HZ> config;
+	(void) sizeof(AdcStaticCheck<config::RATE_CHECK>);
+	dacTimerStart(config::CLOCK_SELECT, config::TOP, config::ACTUAL_HZ);
+}
+#endif
 
 
 #endif /* DAC_H_ */
\ No newline at end of file
@@ -0,0 +1,54 @@
+/**
+* @file dac_dds.h
+* @author Christoph Jurczyk
+* @date December 08, 2018
+* @brief Header file for the DDS waveform generator on the DAC
+*
+*
+* @section license License
+* This library is released under the GNU General Public License v3.0.
+*
+*/
+
+#ifndef DAC_DDS_H_
+#define DAC_DDS_H_
+
+// ##### Includes #####
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+#include <stdio.h>
+#include "dac.h"
+
+
+// ##### Definitions #####
+/** Number of entries of a waveform table (one period) */
+#define DAC_DDS_TABLE_SIZE 256
+
+/**
+ *
+ * \enum    DAC_DDS_WAVE
+ *
+ * \brief   Enum class for the waveforms of the DDS generator
+**/
+enum DAC_DDS_WAVE {
+	/// Sine from the built-in table
+	DAC_DDS_SINE,
+	/// Triangle, calculated from the phase
+	DAC_DDS_TRIANGLE,
+	/// Sawtooth, calculated from the phase
+	DAC_DDS_SAWTOOTH,
+	/// Arbitrary waveform from a table in flash (DAC_DDS_TABLE_SIZE signed values -127..127)
+	DAC_DDS_TABLE,
+	};
+
+
+// ##### Functions #####
+bool dacDdsStart(DAC_DDS_WAVE wave, const int8_t *table);
+void dacDdsStop(void);
+bool dacDdsFrequency(uint16_t freq_hz);
+void dacDdsIncrement(uint16_t increment);
+void dacDdsAmplitude(uint16_t amplitude);
+void dacDdsOffset(uint16_t offset);
+
+
+#endif /* DAC_DDS_H_ */
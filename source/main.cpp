@@ -8,9 +8,9 @@
 * \mainpage Description
 * This is the documentation for the UART, ADC, DAC libraries for the ATmega16M1, ATmega32M1 and ATmega64M1.
 *
-* Note: Floating point is only used for showing
-* the functionality in example main.cpp. For professional use
-* it is recommend to use integer values.
+* Note: The example uses integer conversions only (adc_units.h, adc_supply.h),
+* so neither the floating point printf (-lprintf_flt) nor the float library
+* is linked.
 *
 * @section license License
 * This library is released under the GNU General Public License v3.0.
@@ -18,7 +18,9 @@
 *
 */
 
+#ifndef F_CPU
 #define F_CPU 8000000UL 
+#endif
 
 #include <stdbool.h>
 #include <stdio.h>
@@ -29,6 +31,8 @@
 #include <util/delay.h>
 #include "adc.h"
 #include "dac.h"
+#include "adc_supply.h"
+#include "adc_units.h"
 
 extern "C" {
 	#include "uart.h"	
@@ -38,9 +42,6 @@ extern "C" {
 #define BAUDRATE 115200 // define desired baudrate
 FILE uart_str;
 
-// VCC declaration
-#define VCC 5.0
-
 // Function declaration
 void hw_config(void);
 
@@ -59,10 +60,14 @@ int main(void)
     while (1)
     {	    	
 		printf("\nNew data:\n");
+		
+		// Measure supply voltage via bandgap
+		adcSupplyMeasure();
+		fprintf(&uart_str, "VCC= %umV\n", adcSupplyMillivolts());
 			
 		// Read VCC/4 via ADC
 		adc_value = adcRead(VCC_4);
-		fprintf(&uart_str, "VCC/4= %.4fV\n", adc_value*VCC/1024.0);
+		fprintf(&uart_str, "VCC/4= %umV\n", adcSupplyToMillivolts(adc_value));
 			
 		// Read internal temperature via ADC
 		temp_value = adcTempRead();
@@ -70,10 +75,10 @@ int main(void)
 			
 		// Read differential voltage via ADC
 		adc_diff_value = adcReadDiff(AMP0,ADC_GAIN5);
-		fprintf(&uart_str, "adc_diff_value= %.4fV\n", adc_diff_value/512.0);
+		fprintf(&uart_str, "adc_diff_value= %lduV\n", AdcDiffUnits<ADC_INTERNAL_VCC_REF, ADC_GAIN5>::microvolts(adc_diff_value));
 			
 		// Write DAC value
-		fprintf(&uart_str, "dac_value= %d (%.4fV)\n", dac_value, dac_value*VCC/1024.0);
+		fprintf(&uart_str, "dac_value= %u (%umV)\n", dac_value, adcSupplyToMillivolts(dac_value));
 		dacWrite(dac_value);
 		dac_value++;
 		if (dac_value > 1023) dac_value = 0;
@@ -99,6 +104,7 @@ void hw_config()
 	adcReference(ADC_INTERNAL_VCC_REF);
 	adcInit(ADC_CLK_DIV_64);
 	adcTempOffset(10); // Offset correction of internal temperature sensor. Depending on hardware, mine needs +10 degC.
+	adcSupplyEnable();
 	
 	// DAC
 	dacInit();
@@ -11,8 +11,13 @@
 #include <stdio.h>
 #include <string.h>
 #include <avr/sfr_defs.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
 #include "uart.h"
 
+/** Receive handler of the interrupt driven reception */
+static volatile UART_RX_HANDLER uart_handler = NULL;
+
 /**
 * @brief UART initialization function
 * 
@@ -38,7 +43,7 @@ void uart_init(uint8_t brr_value)
 	LINCR = _BV(LENA);  // Clear LINCR and enable byte transfer mode
 	LINCR |= _BV( LCMD2) | _BV( LCMD1) | _BV( LCMD0);  // Set UART to full duplex
 	PORTD |= _BV( PORTD4); // Enable pull-up on RX
-	LINENIR |= _BV(LENRXOK) | _BV(LENTXOK); // Enable Transmit and Receive Performed Interrupt
+	LINENIR = 0; // Polled operation, the receive interrupt is enabled by uart_rx_handler()
 }
 
 /**
@@ -60,11 +65,40 @@ void uart_init(uint8_t brr_value)
 */
 int uart_transmit(char byte_data, FILE *stream)
 {
-	while (LINSIR & _BV(LBUSY));  // wait for free buffer	
-	LINDAT = byte_data;
+	while (!uart_transmit_try(byte_data));  // wait for free buffer
 	return 0;
 }
 
+/**
+* @brief Function to transmit a character if the transmitter is free.
+* 
+* The check of the transmitter and the write are done with disabled interrupts, so the
+* function can be used by interrupt handlers and the main loop at the same time.
+* Example call:
+* @code
+* if (!uart_transmit_try('a')) { ... }
+* @endcode
+*
+* @param byte_data
+* Is the to transmitted data e.g. a character.
+*
+* @return Returns 1 if the character was written, 0 if the transmitter is busy.
+*/
+uint8_t uart_transmit_try(uint8_t byte_data)
+{
+	uint8_t done = 0;
+	
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (!(LINSIR & _BV(LBUSY)))
+		{
+			LINDAT = byte_data;
+			done = 1;
+		}
+	}
+	return done;
+}
+
 /**
 * @brief Function to read characters.
 * 
@@ -127,4 +161,47 @@ int uart_getline(char line[], int max)
 
 	line[nch] = '\0';
 	return nch;
-}
\ No newline at end of file
+}
+
+/**
+* @brief Function to set a handler for interrupt driven reception.
+* 
+* With a handler the Receive Performed interrupt is enabled and every received byte is passed
+* to the handler in interrupt context, uart_receive() must not be used then.
+* Global interrupts have to be enabled with sei().
+* Example call:
+* @code
+* uart_rx_handler(my_handler);
+* @endcode
+*
+* @param handler
+* Is the receive handler or NULL to return to polled reception.
+*/
+void uart_rx_handler(UART_RX_HANDLER handler)
+{
+	LINENIR &= ~_BV(LENRXOK);
+	uart_handler = handler;
+	if (handler != NULL)
+	{
+		LINSIR = _BV(LRXOK); // Clear old reception
+		LINENIR |= _BV(LENRXOK); // Enable Receive Performed Interrupt
+	}
+}
+
+/**
+* @brief LIN/UART transfer complete interrupt, passes the received byte to the receive handler.
+*/
+ISR(LIN_TC_vect)
+{
+	if (LINSIR & _BV(LRXOK))
+	{
+		uint8_t byte_data = LINDAT;
+		LINSIR = _BV(LRXOK); // Clear flag
+		
+		UART_RX_HANDLER handler = uart_handler;
+		if (handler != NULL)
+		{
+			handler(byte_data);
+		}
+	}
+}
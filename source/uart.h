@@ -25,12 +25,17 @@
 /** Calculation of LINBRR value for UART initialization. */
 #define BAUD_CALC(baud) ((F_CPU / 4 / baud - 1) / 2)
 
+/** Receive handler, called by the LIN/UART interrupt for every received byte. */
+typedef void (*UART_RX_HANDLER)(uint8_t byte_data);
+
 
 // ##### Functions #####
 void uart_init(uint8_t brr_value);
 int uart_transmit(char byte_data, FILE *stream);
+uint8_t uart_transmit_try(uint8_t byte_data);
 int uart_receive(FILE *stream);
 int uart_getline(char line[], int max);
+void uart_rx_handler(UART_RX_HANDLER handler);
 
 
 #endif /* UART_H_ */
\ No newline at end of file
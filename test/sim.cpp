@@ -0,0 +1,162 @@
+/**
+* @file sim.cpp
+* @brief Register simulation of the ADC for the host unit tests
+*
+*/
+
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include "sim.h"
+
+SimReg8 ADMUX, ADCSRA, ADCSRB, ADCH, ADCL, DIDR0, DIDR1;
+SimReg16 ADCW;
+SimReg8 AMP0CSR, AMP1CSR, AMP2CSR;
+SimReg8 DACON, DACL, DACH;
+SimReg8 SREG, SMCR;
+SimReg8 TCCR0A, TCCR0B, OCR0A, OCR0B, TIMSK0, TIFR0, TCNT0;
+SimReg8 TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+SimReg16 OCR1A, OCR1B, ICR1, TCNT1;
+SimReg8 LINSIR, LINENIR, LINCR, LINDAT, LINBTR, LINBRR, PORTD;
+
+/** Input function of the simulated ADC */
+static SIM_ADC_INPUT sim_adc_input = NULL;
+/** Number of completed conversions */
+static uint16_t sim_adc_conversions = 0;
+
+
+/**
+* @brief Function to complete a conversion
+*/
+static void simAdcConvert(void)
+{
+	uint16_t code = (sim_adc_input != NULL) ? (sim_adc_input(ADMUX) & 0x3FF) : 0;
+	
+	if (ADMUX & (1 << ADLAR))
+	{
+		ADCW.value = code << 6;
+	}
+	else
+	{
+		ADCW.value = code;
+	}
+	ADCH.value = ADCW.value >> 8;
+	ADCL.value = ADCW.value & 0xFF;
+	ADCSRA.value = (ADCSRA.value & ~(1 << ADSC)) | (1 << ADIF);
+	sim_adc_conversions++;
+}
+
+
+/**
+* @brief Write hook of ADCSRA: ADIF is cleared by writing one, ADSC starts a conversion
+*/
+static void simAdcsraWrite(SimReg8 &reg, uint8_t value)
+{
+	uint8_t flag = (value & (1 << ADIF)) ? 0 : (reg.value & (1 << ADIF));
+	
+	reg.value = (value & ~(1 << ADIF)) | flag;
+	if ((reg.value & (1 << ADEN)) && (reg.value & (1 << ADSC)))
+	{
+		simAdcConvert();
+	}
+}
+
+
+/**
+* @brief Function to reset the simulated registers
+* The state of the libraries is not reset, every test has to stop what it started.
+*/
+void simReset(void)
+{
+	ADMUX.value = 0;
+	ADCSRA.value = 0;
+	ADCSRB.value = 0;
+	ADCW.value = 0;
+	SREG.value = 0;
+	SMCR.value = 0;
+	ADCSRA.hook = simAdcsraWrite;
+	sim_adc_input = NULL;
+	sim_adc_conversions = 0;
+}
+
+
+/**
+* @brief Function to set the input of the simulated ADC
+*
+* @param input
+* Is the input function or NULL for a result of 0
+*/
+void simAdcInput(SIM_ADC_INPUT input)
+{
+	sim_adc_input = input;
+}
+
+
+/**
+* @brief Function to read the number of completed conversions
+*
+* @return Returns the number of conversions since simReset()
+*/
+uint16_t simAdcConversions(void)
+{
+	return sim_adc_conversions;
+}
+
+
+/**
+* @brief Function to execute the ADC interrupt if it is pending and enabled
+*
+* @return Returns true if the interrupt handler was called
+*/
+bool simAdcService(void)
+{
+	if ((ADCSRA.value & (1 << ADIF)) && (ADCSRA.value & (1 << ADIE)))
+	{
+		ADCSRA.value &= ~(1 << ADIF);
+		ADC_vect();
+		return true;
+	}
+	return false;
+}
+
+
+/**
+* @brief Function to execute the ADC interrupt until no conversion is pending
+*
+* @return Returns the number of calls of the interrupt handler (at most 10000)
+*/
+uint16_t simAdcServiceAll(void)
+{
+	uint16_t count = 0;
+	
+	while (count < 10000 && simAdcService())
+	{
+		count++;
+	}
+	return count;
+}
+
+
+/**
+* @brief Function to signal the auto trigger event, a conversion is done if ADATE is set
+*/
+void simAdcTrigger(void)
+{
+	if ((ADCSRA.value & (1 << ADEN)) && (ADCSRA.value & (1 << ADATE)))
+	{
+		simAdcConvert();
+	}
+}
+
+
+/**
+* @brief Function to simulate the sleep instruction
+* In ADC Noise Reduction mode a conversion is started. A pending ADC interrupt wakes the CPU up.
+*/
+void simSleepCpu(void)
+{
+	if ((SMCR.value & ((1 << SM2)|(1 << SM1)|(1 << SM0))) == SLEEP_MODE_ADC && (ADCSRA.value & (1 << ADEN)))
+	{
+		simAdcConvert();
+	}
+	simAdcService();
+}
@@ -0,0 +1,29 @@
+/**
+* @file sim.h
+* @brief Register simulation of the ADC for the host unit tests
+*
+* A write of ADSC to ADCSRA completes a conversion immediately: the result of the input
+* function is stored in ADCW/ADCH and ADIF is set. The interrupt handler is called by
+* simAdcService(), blocking functions work with disabled interrupts through adcPoll().
+*
+*/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <avr/io.h>
+
+/** Input of the simulated ADC, returns the 10 bit result for the ADMUX value of the conversion */
+typedef uint16_t (*SIM_ADC_INPUT)(uint8_t admux);
+
+extern "C" void ADC_vect(void);
+
+void simReset(void);
+void simAdcInput(SIM_ADC_INPUT input);
+uint16_t simAdcConversions(void);
+bool simAdcService(void);
+uint16_t simAdcServiceAll(void);
+void simAdcTrigger(void);
+
+
+#endif /* SIM_H_ */
@@ -0,0 +1,19 @@
+/**
+* @file interrupt.h
+* @brief Host stub of <avr/interrupt.h> for the unit tests
+*
+* An interrupt handler is a plain function, the simulation calls it (see sim.h).
+*
+*/
+
+#ifndef SIM_AVR_INTERRUPT_H_
+#define SIM_AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) extern "C" void vector(void); extern "C" void vector(void)
+
+static inline void sei(void) { SREG |= (1 << SREG_I); }
+static inline void cli(void) { SREG &= ~(1 << SREG_I); }
+
+#endif /* SIM_AVR_INTERRUPT_H_ */
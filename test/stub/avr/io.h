@@ -0,0 +1,74 @@
+/**
+* @file io.h
+* @brief Host stub of <avr/io.h> for the unit tests
+*
+* The registers are objects of SimReg, a write can be intercepted by a hook of the
+* simulation (see sim.h). Only the registers and bits used by the libraries are declared.
+*
+*/
+
+#ifndef SIM_AVR_IO_H_
+#define SIM_AVR_IO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/sfr_defs.h>
+
+/**
+ *
+ * \class   SimReg
+ *
+ * \brief   Simulated I/O register, reads return the value, writes call the hook if one is set
+**/
+template<typename T>
+class SimReg {
+public:
+	/// Write hook, it has to store the new value itself
+	typedef void (*Hook)(SimReg<T> &reg, T value);
+	
+	SimReg() : value(0), hook(NULL) {}
+	operator T() const { return value; }
+	SimReg &operator=(T v) { write(v); return *this; }
+	SimReg &operator|=(int v) { write((T)(value | v)); return *this; }
+	SimReg &operator&=(int v) { write((T)(value & v)); return *this; }
+	SimReg &operator^=(int v) { write((T)(value ^ v)); return *this; }
+	
+	/// Current register value
+	T value;
+	/// Write hook or NULL
+	Hook hook;
+	
+private:
+	SimReg(const SimReg &);
+	void write(T v) { if (hook != NULL) hook(*this, v); else value = v; }
+	};
+
+typedef SimReg<uint8_t> SimReg8;
+typedef SimReg<uint16_t> SimReg16;
+
+extern SimReg8 ADMUX, ADCSRA, ADCSRB, ADCH, ADCL, DIDR0, DIDR1;
+extern SimReg16 ADCW;
+extern SimReg8 AMP0CSR, AMP1CSR, AMP2CSR;
+extern SimReg8 DACON, DACL, DACH;
+extern SimReg8 SREG, SMCR;
+extern SimReg8 TCCR0A, TCCR0B, OCR0A, OCR0B, TIMSK0, TIFR0, TCNT0;
+extern SimReg8 TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern SimReg16 OCR1A, OCR1B, ICR1, TCNT1;
+extern SimReg8 LINSIR, LINENIR, LINCR, LINDAT, LINBTR, LINBRR, PORTD;
+
+enum {
+	REFS1 = 7, REFS0 = 6, ADLAR = 5,
+	ADEN = 7, ADSC = 6, ADATE = 5, ADIF = 4, ADIE = 3, ADPS2 = 2, ADPS1 = 1, ADPS0 = 0,
+	ADHSM = 7, ISRCEN = 6, AREFEN = 5, ADTS3 = 3, ADTS2 = 2, ADTS1 = 1, ADTS0 = 0,
+	AMP0EN = 7, AMP0IS = 6, AMP0G1 = 5, AMP0G0 = 4, AMPCMP0 = 3, AMP0TS2 = 2, AMP0TS1 = 1, AMP0TS0 = 0,
+	AMP1EN = 7, AMP1IS = 6, AMP1G1 = 5, AMP1G0 = 4, AMPCMP1 = 3, AMP1TS2 = 2, AMP1TS1 = 1, AMP1TS0 = 0,
+	AMP2EN = 7, AMP2IS = 6, AMP2G1 = 5, AMP2G0 = 4, AMPCMP2 = 3, AMP2TS2 = 2, AMP2TS1 = 1, AMP2TS0 = 0,
+	DAATE = 7, DATS2 = 6, DATS1 = 5, DATS0 = 4, DALA = 2, DAOE = 1, DAEN = 0,
+	SM2 = 3, SM1 = 2, SM0 = 1, SE = 0,
+	WGM01 = 1, WGM00 = 0, WGM02 = 3, CS02 = 2, CS01 = 1, CS00 = 0, OCIE0B = 2, OCIE0A = 1, TOIE0 = 0, OCF0B = 2, OCF0A = 1, TOV0 = 0,
+	WGM13 = 4, WGM12 = 3, CS12 = 2, CS11 = 1, CS10 = 0, OCIE1B = 2, OCIE1A = 1, TOIE1 = 0, OCF1B = 2, OCF1A = 1, TOV1 = 0,
+	LBUSY = 4, LRXOK = 0, LENRXOK = 0, LENA = 3, LCMD2 = 2, LCMD1 = 1, LCMD0 = 0, PORTD4 = 4,
+	SREG_I = 7
+	};
+
+#endif /* SIM_AVR_IO_H_ */
@@ -0,0 +1,16 @@
+/**
+* @file pgmspace.h
+* @brief Host stub of <avr/pgmspace.h> for the unit tests
+*
+*/
+
+#ifndef SIM_AVR_PGMSPACE_H_
+#define SIM_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+
+#endif /* SIM_AVR_PGMSPACE_H_ */
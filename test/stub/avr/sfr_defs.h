@@ -0,0 +1,15 @@
+/**
+* @file sfr_defs.h
+* @brief Host stub of <avr/sfr_defs.h> for the unit tests
+*
+*/
+
+#ifndef SIM_AVR_SFR_DEFS_H_
+#define SIM_AVR_SFR_DEFS_H_
+
+#define _BV(bit) (1 << (bit))
+#define bit_is_set(sfr, bit) ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit) (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit) do {} while (bit_is_clear(sfr, bit))
+
+#endif /* SIM_AVR_SFR_DEFS_H_ */
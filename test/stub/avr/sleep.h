@@ -0,0 +1,24 @@
+/**
+* @file sleep.h
+* @brief Host stub of <avr/sleep.h> for the unit tests
+*
+* sleep_cpu() is passed to the simulation, which completes the pending events.
+*
+*/
+
+#ifndef SIM_AVR_SLEEP_H_
+#define SIM_AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE 0x00
+#define SLEEP_MODE_ADC (1 << SM0)
+
+void simSleepCpu(void);
+
+#define set_sleep_mode(mode) (SMCR = (SMCR & ~((1 << SM2)|(1 << SM1)|(1 << SM0))) | (mode))
+#define sleep_enable() (SMCR |= (1 << SE))
+#define sleep_disable() (SMCR &= ~(1 << SE))
+#define sleep_cpu() simSleepCpu()
+
+#endif /* SIM_AVR_SLEEP_H_ */
@@ -0,0 +1,29 @@
+/**
+* @file atomic.h
+* @brief Host stub of <util/atomic.h> for the unit tests
+*
+* The block clears the I bit of the simulated SREG and restores it on every exit.
+*
+*/
+
+#ifndef SIM_UTIL_ATOMIC_H_
+#define SIM_UTIL_ATOMIC_H_
+
+#include <avr/io.h>
+
+/** Guard of an atomic block */
+class SimAtomic {
+public:
+	SimAtomic() : sreg(SREG), done(false) { SREG &= ~(1 << SREG_I); }
+	~SimAtomic() { SREG = sreg; }
+	bool once(void) { bool first = !done; done = true; return first; }
+private:
+	uint8_t sreg;
+	bool done;
+	};
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (SimAtomic sim_atomic; sim_atomic.once(); )
+
+#endif /* SIM_UTIL_ATOMIC_H_ */
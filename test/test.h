@@ -0,0 +1,34 @@
+/**
+* @file test.h
+* @brief Minimal check macros of the host unit tests
+*
+*/
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <stdio.h>
+
+/** Number of failed checks */
+static int test_failures = 0;
+
+/** Check a condition */
+#define CHECK(condition) do { \
+	if (!(condition)) { \
+		printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} } while (0)
+
+/** Check two integer values for equality */
+#define CHECK_EQUAL(expected, actual) do { \
+	long test_expected = (long)(expected); \
+	long test_actual = (long)(actual); \
+	if (test_expected != test_actual) { \
+		printf("%s:%d: %s == %ld, expected %ld\n", __FILE__, __LINE__, #actual, test_actual, test_expected); \
+		test_failures++; \
+	} } while (0)
+
+/** Print the result, returns the exit code of the test */
+#define TEST_RESULT(name) (printf("%s: %s\n", name, test_failures ? "FAILED" : "passed"), test_failures ? 1 : 0)
+
+#endif /* TEST_H_ */
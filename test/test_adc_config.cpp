@@ -0,0 +1,163 @@
+/**
+* @file test_adc_config.cpp
+* @brief Host test of the compile-time register configuration: AdcRefBits, AdcConfig and DacConfig
+*
+* Every combination of the template parameters is instantiated by a template recursion and
+* compared with the register values of the datasheet and with the runtime functions.
+*
+*/
+
+#include <avr/io.h>
+#include "sim.h"
+#include "test.h"
+#include "adc.h"
+#include "dac.h"
+#include "vref.h"
+
+/** Number of voltage reference selections */
+#define REF_COUNT 5
+/** Number of clock dividers */
+#define CLK_DIV_COUNT 7
+
+/** REFS1:0 of each reference selection according to the datasheet */
+static const uint8_t expected_refs[REF_COUNT] = { 0, 1, 1, 3, 3 };
+/** AREFEN of each reference selection (AREF pin used) according to the datasheet */
+static const uint8_t expected_arefen[REF_COUNT] = { 1, 1, 0, 1, 0 };
+/** ADPS2:0 of each clock divider according to the datasheet */
+static const uint8_t expected_adps[CLK_DIV_COUNT] = { 1, 2, 3, 4, 5, 6, 7 };
+
+
+/**
+* @brief Function to reset the registers and the reference shadows
+*/
+static void reset(void)
+{
+	simReset();
+	DACON.value = 0;
+	vref_mode = VREF_UNKNOWN;
+	vref_admux = 0;
+}
+
+
+/**
+ *
+ * \struct  TestAdcConfig
+ *
+ * \brief   Checks AdcConfig of one reference selection for all clock dividers
+**/
+template<uint8_t REF, uint8_t CLK_DIV>
+struct TestAdcConfig {
+	static void run(void)
+	{
+		typedef AdcConfig<(ADC_REF) REF, (ADC_CLK_DIV) CLK_DIV> Config;
+
+		uint8_t admux = expected_refs[REF] << REFS0;
+		uint8_t adcsrb = expected_arefen[REF] << AREFEN;
+		uint8_t adcsra = (1 << ADEN) | expected_adps[CLK_DIV];
+
+		CHECK_EQUAL(admux, Config::ADMUX_VALUE);
+		CHECK_EQUAL(adcsrb, Config::ADCSRB_VALUE);
+		CHECK_EQUAL(adcsra, Config::ADCSRA_VALUE);
+
+		// apply() writes the registers and the shadows, followed by one dummy conversion
+		reset();
+		Config::apply();
+		CHECK_EQUAL(admux, ADMUX);
+		CHECK_EQUAL(adcsrb, ADCSRB);
+		CHECK_EQUAL(adcsra, ADCSRA & ~(1 << ADIF));
+		CHECK_EQUAL(admux, vref_admux);
+		CHECK_EQUAL(REF, vref_mode);
+		CHECK_EQUAL(1, simAdcConversions());
+
+		// Same registers as the runtime configuration
+		reset();
+		adcReference((ADC_REF) REF);
+		adcInit((ADC_CLK_DIV) CLK_DIV);
+		CHECK_EQUAL(admux, ADMUX);
+		CHECK_EQUAL(adcsrb, ADCSRB);
+		CHECK_EQUAL(adcsra, ADCSRA & ~(1 << ADIF));
+		CHECK_EQUAL(REF, adcGetReference());
+
+		TestAdcConfig<REF, CLK_DIV + 1>::run();
+	}
+	};
+
+template<uint8_t REF>
+struct TestAdcConfig<REF, CLK_DIV_COUNT> {
+	static void run(void) {}
+	};
+
+
+/**
+ *
+ * \struct  TestRefConfig
+ *
+ * \brief   Checks AdcRefBits, AdcConfig and DacConfig of one reference selection and the following ones
+**/
+template<uint8_t REF>
+struct TestRefConfig {
+	static void run(void)
+	{
+		uint8_t admux = expected_refs[REF] << REFS0;
+		uint8_t adcsrb = expected_arefen[REF] << AREFEN;
+
+		CHECK_EQUAL(admux, AdcRefBits<REF>::ADMUX_BITS);
+		CHECK_EQUAL(adcsrb, AdcRefBits<REF>::ADCSRB_BITS);
+
+		TestAdcConfig<REF, 0>::run();
+
+		// DacConfig uses the shared reference and enables the DAC with its output
+		uint8_t dacon = (1 << DAEN) | (1 << DAOE);
+		CHECK_EQUAL(dacon, DacConfig<(DAC_REF) REF>::DACON_VALUE);
+
+		// apply() keeps the ADC bits of ADMUX and ADCSRB
+		reset();
+		ADMUX.value = (1 << REFS1) | (1 << ADLAR) | ADC5;
+		ADCSRB.value = (1 << ISRCEN) | (1 << ADTS0);
+		DacConfig<(DAC_REF) REF>::apply();
+		CHECK_EQUAL(admux | (1 << ADLAR) | ADC5, ADMUX);
+		CHECK_EQUAL(adcsrb | (1 << ADTS0), ADCSRB);
+		CHECK_EQUAL(dacon, DACON);
+		CHECK_EQUAL(admux, vref_admux);
+		CHECK_EQUAL(REF, dacGetReference());
+
+		// Same registers as the runtime configuration
+		reset();
+		dacReference((DAC_REF) REF);
+		dacInit();
+		CHECK_EQUAL(admux, ADMUX);
+		CHECK_EQUAL(adcsrb, ADCSRB);
+		CHECK_EQUAL(dacon, DACON);
+
+		TestRefConfig<REF + 1>::run();
+	}
+	};
+
+template<>
+struct TestRefConfig<REF_COUNT> {
+	static void run(void) {}
+	};
+
+
+/**
+* @brief The reference bits are the same for ::ADC_REF and ::DAC_REF
+*/
+static void testEnumValues(void)
+{
+	CHECK_EQUAL(ADC_EXTERNAL_REF, DAC_EXTERNAL_REF);
+	CHECK_EQUAL(ADC_INTERNAL_VCC_EXT_CAP, DAC_INTERNAL_VCC_EXT_CAP);
+	CHECK_EQUAL(ADC_INTERNAL_VCC_REF, DAC_INTERNAL_VCC_REF);
+	CHECK_EQUAL(ADC_INTERAL_2V56_CAP, DAC_INTERAL_2V56_CAP);
+	CHECK_EQUAL(ADC_INTERNAL_2V56, DAC_INTERNAL_2V56);
+	CHECK_EQUAL(REF_COUNT - 1, ADC_INTERNAL_2V56);
+	CHECK_EQUAL(CLK_DIV_COUNT - 1, ADC_CLK_DIV_128);
+}
+
+
+int main(void)
+{
+	testEnumValues();
+	TestRefConfig<0>::run();
+
+	return TEST_RESULT("test_adc_config");
+}
@@ -0,0 +1,263 @@
+/**
+* @file test_adc_engine.cpp
+* @brief Host test of the ADC conversion engine: blocking reads, sample queue and completion path
+*
+*/
+
+#include <avr/io.h>
+#include "sim.h"
+#include "test.h"
+#include "adc.h"
+#include "vref.h"
+
+/** Simulated input of each channel */
+static uint16_t input_code[32];
+/** Channel and value of the last completion callback */
+static uint8_t callback_channel;
+static uint16_t callback_value;
+static uint8_t callback_count = 0;
+
+
+/**
+* @brief Input of the simulated ADC, the temperature sensor only works with the 2.56V reference
+*/
+static uint16_t input(uint8_t admux)
+{
+	uint8_t channel = admux & 0x1F;
+	
+	if (channel == TEMP_SENSOR && (admux & VREF_ADMUX_MASK) != AdcRefBits<ADC_INTERNAL_2V56>::ADMUX_BITS)
+	{
+		return 0;
+	}
+	return input_code[channel];
+}
+
+static void callback(uint8_t channel, uint16_t value)
+{
+	callback_channel = channel;
+	callback_value = value;
+	callback_count++;
+}
+
+static uint16_t hookAddOne(uint8_t channel, uint16_t value)
+{
+	return value + 1;
+}
+
+
+static void testInit(void)
+{
+	adcInit(ADC_CLK_DIV_64);
+	CHECK_EQUAL((1 << ADEN) | 6, ADCSRA & ~(1 << ADIF));
+	CHECK_EQUAL(1, simAdcConversions());
+	
+	CHECK_EQUAL(VREF_SETTLE_US, adcReference(ADC_INTERNAL_VCC_REF));
+	CHECK_EQUAL(0, adcReference(ADC_INTERNAL_VCC_REF));
+	CHECK_EQUAL(ADC_INTERNAL_VCC_REF, adcGetReference());
+	CHECK_EQUAL(1 << REFS0, ADMUX & VREF_ADMUX_MASK);
+}
+
+
+static void testBlockingRead(void)
+{
+	uint16_t start = simAdcConversions();
+	
+	// First conversion with the new reference: ADC_REF_SETTLE results are discarded
+	input_code[ADC3] = 0x155;
+	CHECK_EQUAL(0x155, adcRead(ADC3));
+	CHECK_EQUAL(1 + ADC_REF_SETTLE, simAdcConversions() - start);
+	CHECK_EQUAL((1 << REFS0) | ADC3, ADMUX);
+	
+	// Same reference: a single conversion
+	start = simAdcConversions();
+	input_code[ADC4] = 1023;
+	CHECK_EQUAL(1023, adcRead(ADC4));
+	CHECK_EQUAL(1, simAdcConversions() - start);
+	
+	// 8 bit read is left adjusted
+	input_code[ADC5] = 0x2F3;
+	uint8_t value8 = 0;
+	CHECK(adcRead8(ADC5, &value8));
+	CHECK_EQUAL(0x2F3 >> 2, value8);
+	CHECK_EQUAL(1 << ADLAR, ADMUX & (1 << ADLAR));
+	CHECK_EQUAL(0x2F3, adcRead(ADC5));
+	CHECK_EQUAL(0, ADMUX & (1 << ADLAR));
+}
+
+
+static void testDiffRead(void)
+{
+	input_code[AMP0] = 0x3FF;
+	CHECK_EQUAL(-1, adcReadDiff(AMP0, ADC_GAIN10));
+	CHECK_EQUAL((1 << AMP0EN) | (ADC_GAIN10 << AMP0G0), AMP0CSR);
+	input_code[AMP0] = 0x200;
+	CHECK_EQUAL(-512, adcReadDiff(AMP0, ADC_GAIN10));
+	input_code[AMP0] = 0x1FF;
+	CHECK_EQUAL(511, adcReadDiff(AMP0, ADC_GAIN10));
+	CHECK_EQUAL(0, adcReadDiff(ADC1, ADC_GAIN10));
+}
+
+
+static void testQueue(void)
+{
+	ADC_SAMPLE sample;
+	
+	input_code[ADC1] = 100;
+	input_code[ADC2] = 200;
+	CHECK(!adcQueueRead(&sample));
+	
+	// One conversion at a time
+	CHECK(adcConvStart(ADC1));
+	CHECK(adcConvBusy());
+	CHECK(!adcConvStart(ADC2));
+	CHECK(!adcStart(ADC2));
+	CHECK_EQUAL(1, simAdcServiceAll());
+	CHECK(!adcConvBusy());
+	CHECK_EQUAL(0, ADCSRA & (1 << ADIE));
+	
+	CHECK(adcConvStart(ADC2));
+	simAdcServiceAll();
+	CHECK_EQUAL(2, adcQueueCount());
+	
+	// Samples are read in order
+	CHECK(adcQueueRead(&sample));
+	CHECK_EQUAL(ADC1, sample.channel);
+	CHECK_EQUAL(100, sample.value);
+	CHECK(adcQueueRead(&sample));
+	CHECK_EQUAL(ADC2, sample.channel);
+	CHECK_EQUAL(200, sample.value);
+	CHECK(!adcQueueRead(&sample));
+	
+	// A full queue drops the samples and counts the overruns
+	uint8_t overruns = adcQueueOverruns();
+	for (uint8_t i = 0; i < ADC_QUEUE_SIZE + 2; i++)
+	{
+		input_code[ADC1] = i;
+		CHECK(adcConvStart(ADC1));
+		simAdcServiceAll();
+	}
+	CHECK_EQUAL(ADC_QUEUE_SIZE - 1, adcQueueCount());
+	CHECK_EQUAL(3, (uint8_t)(adcQueueOverruns() - overruns));
+	for (uint8_t i = 0; i < ADC_QUEUE_SIZE - 1; i++)
+	{
+		CHECK(adcQueueRead(&sample));
+		CHECK_EQUAL(i, sample.value);
+	}
+	CHECK_EQUAL(0, adcQueueCount());
+}
+
+
+static void testCompletion(void)
+{
+	input_code[ADC6] = 0x123;
+	callback_count = 0;
+	CHECK(adcStartCallback(ADC6, callback));
+	CHECK(!adcReady());
+	CHECK_EQUAL(1, simAdcServiceAll());
+	CHECK_EQUAL(1, callback_count);
+	CHECK_EQUAL(ADC6, callback_channel);
+	CHECK_EQUAL(0x123, callback_value);
+	CHECK(adcReady());
+	CHECK_EQUAL(0x123, adcResult());
+	CHECK(!adcReady());
+	
+	// Hooks change the value before the completion
+	adcHookSet(ADC_HOOK_FILTER, hookAddOne);
+	CHECK(adcStartCallback(ADC6, callback));
+	simAdcServiceAll();
+	CHECK_EQUAL(0x124, callback_value);
+	CHECK_EQUAL(0x124, adcRead(ADC6));
+	adcHookSet(ADC_HOOK_FILTER, NULL);
+	CHECK_EQUAL(0x123, adcRead(ADC6));
+}
+
+
+static void testTemperature(void)
+{
+	uint16_t start = simAdcConversions();
+	
+	input_code[TEMP_SENSOR] = 300;
+	CHECK_EQUAL(20, adcTempRead());
+	CHECK_EQUAL(ADC_TEMP_SAMPLES + ADC_REF_SETTLE, simAdcConversions() - start);
+	
+	// Reference is switched back for the DAC
+	CHECK_EQUAL(1 << REFS0, ADMUX & VREF_ADMUX_MASK);
+	
+	// Next conversion waits for the reference
+	start = simAdcConversions();
+	CHECK_EQUAL(0x155, adcRead(ADC3));
+	CHECK_EQUAL(1 + ADC_REF_SETTLE, simAdcConversions() - start);
+}
+
+
+static void testScan(void)
+{
+	static const ADC_SCAN_ENTRY table[] = {
+		{ ADC1, ADC_GAIN5 },
+		{ AMP1, ADC_GAIN20 },
+		{ TEMP_SENSOR, ADC_GAIN5 }
+		};
+	uint16_t values[ADC_CH_NUM];
+	uint8_t sequence = adcScanSequence();
+	
+	input_code[ADC1] = 11;
+	input_code[AMP1] = 0x3FE;
+	CHECK(adcScanStart(table, 3, false));
+	CHECK(!adcConvStart(ADC1));
+	simAdcServiceAll();
+	CHECK(!adcConvBusy());
+	CHECK_EQUAL(1, (uint8_t)(adcScanSequence() - sequence));
+	CHECK_EQUAL(1, (uint8_t)(adcScanSnapshot(values) - sequence));
+	CHECK_EQUAL(11, values[ADC1]);
+	CHECK_EQUAL(-2, (int16_t) values[AMP1]);
+	CHECK_EQUAL(300, values[TEMP_SENSOR]);
+	
+	// A one-shot scan ending on the temperature sensor switches the reference back
+	CHECK_EQUAL(1 << REFS0, ADMUX & VREF_ADMUX_MASK);
+}
+
+
+static void testContinuousBusy(void)
+{
+	// Blocking reads fail instead of waiting for the continuous conversions
+	CHECK(adcContinuousStart(ADC2, ADC_TRIG_FREE_RUNNING, NULL, 0));
+	simAdcServiceAll();
+	simAdcTrigger();
+	simAdcServiceAll();
+	CHECK_EQUAL(ADC_BUSY, adcRead(ADC1));
+	CHECK_EQUAL(ADC_BUSY, adcReadOversampled(ADC1, 1));
+	CHECK_EQUAL(ADC_TEMP_BUSY, adcTempRead());
+	// A busy 8 bit read is not mistaken for a 0 result
+	uint8_t value8 = 0x55;
+	CHECK(!adcRead8(ADC1, &value8));
+	CHECK_EQUAL(0x55, value8);
+	adcContinuousStop();
+	CHECK_EQUAL(11, adcRead(ADC1));
+	
+	// Same for a continuous scan, until it is stopped
+	static const ADC_SCAN_ENTRY table[] = { { ADC1, ADC_GAIN5 } };
+	CHECK(adcScanStart(table, 1, true));
+	simAdcService();
+	CHECK_EQUAL(ADC_BUSY, adcRead(ADC1));
+	adcScanStop();
+	CHECK(!adcConvBusy());
+	CHECK_EQUAL(11, adcRead(ADC1));
+}
+
+
+int main(void)
+{
+	simReset();
+	simAdcInput(input);
+	
+	testInit();
+	testBlockingRead();
+	testDiffRead();
+	testQueue();
+	testCompletion();
+	testTemperature();
+	testScan();
+	testContinuousBusy();
+	
+	return TEST_RESULT("test_adc_engine");
+}
@@ -0,0 +1,156 @@
+/**
+* @file test_adc_enob.cpp
+* @brief Host test of the effective number of bits of oversampled conversions
+*
+* A ramp of analog values with Gaussian noise is quantized to 10 bit by the simulated ADC.
+* The RMS error of the oversampled result against the analog value gives the ENOB.
+* The differential channels return two's complement codes, their oversampled result is signed.
+*
+*/
+
+#include <avr/io.h>
+#include <math.h>
+#include "sim.h"
+#include "test.h"
+#include "adc.h"
+
+/** Analog input in LSB of the 10 bit ADC */
+static double analog_value = 0.0;
+/** RMS noise of the input in LSB */
+static double noise_lsb = 0.0;
+/** State of the pseudo random generator */
+static uint32_t random_state = 12345;
+
+
+/**
+* @brief Function to generate a uniform random number in (0, 1)
+*/
+static double random_uniform(void)
+{
+	random_state = random_state * 1103515245UL + 12345UL;
+	return ((random_state >> 8) + 0.5) / 16777216.0;
+}
+
+/**
+* @brief Function to generate a normal distributed random number (Box-Muller)
+*/
+static double random_normal(void)
+{
+	return sqrt(-2.0 * log(random_uniform())) * cos(2.0 * M_PI * random_uniform());
+}
+
+/**
+* @brief Input of the simulated ADC: the analog value plus noise, rounded and limited to 10 bit
+* The differential channels convert -512..511 LSB into a two's complement code.
+*/
+static uint16_t input(uint8_t admux)
+{
+	uint8_t channel = admux & 0x1F;
+	double x = floor(analog_value + noise_lsb * random_normal() + 0.5);
+	
+	if (channel >= AMP0 && channel <= AMP2)
+	{
+		if (x < -512.0) x = -512.0;
+		if (x > 511.0) x = 511.0;
+		return (uint16_t)(int16_t) x & 0x3FF;
+	}
+	if (x < 0.0) return 0;
+	if (x > 1023.0) return 1023;
+	return (uint16_t) x;
+}
+
+
+/**
+* @brief Function to do an oversampled conversion, the simulation executes the ADC interrupts
+*/
+static uint16_t oversample(ADC_CH channel, uint8_t extra_bits)
+{
+	CHECK(adcOversampleStart(channel, extra_bits));
+	simAdcServiceAll();
+	CHECK(!adcConvBusy());
+	return adcOversampleResult();
+}
+
+
+/**
+* @brief Function to measure the ENOB of oversampled conversions over a ramp
+*
+* @param extra_bits
+* Is the number of additional bits of the oversampled conversion
+*
+* @return Returns the effective number of bits
+*/
+static double enob(uint8_t extra_bits)
+{
+	const uint16_t points = 400;
+	double scale = 1.0 / (1 << extra_bits);
+	double sum = 0.0;
+	
+	for (uint16_t i = 0; i < points; i++)
+	{
+		analog_value = 100.0 + 1.9973 * i;
+		uint16_t result = oversample(ADC2, extra_bits);
+		// The decimation truncates, so the centre of the result LSB is the estimate
+		double error = (result + (extra_bits ? 0.5 : 0.0)) * scale - analog_value;
+		sum += error * error;
+	}
+	double rms = sqrt(sum / points);
+	return log(1024.0 / (rms * sqrt(12.0))) / log(2.0);
+}
+
+
+int main(void)
+{
+	simReset();
+	simAdcInput(input);
+	adcInit(ADC_CLK_DIV_64);
+	
+	// 1 LSB of noise: every additional bit improves the resolution
+	noise_lsb = 1.0;
+	double last = enob(0);
+	printf("noise %.1f LSB: extra bits 0 ENOB %.2f\n", noise_lsb, last);
+	CHECK(last > 7.5 && last < 9.0);
+	for (uint8_t bits = 1; bits <= ADC_OVERSAMPLE_MAX_BITS; bits++)
+	{
+		double value = enob(bits);
+		printf("noise %.1f LSB: extra bits %u ENOB %.2f\n", noise_lsb, bits, value);
+		CHECK(value > last + 0.7);
+		last = value;
+	}
+	CHECK(last > 11.0);
+	
+	// Without noise the conversions are identical and oversampling does not help
+	noise_lsb = 0.0;
+	double quiet = enob(0);
+	double quiet_oversampled = enob(ADC_OVERSAMPLE_MAX_BITS);
+	printf("noise %.1f LSB: extra bits 0 ENOB %.2f, extra bits %u ENOB %.2f\n", noise_lsb, quiet, ADC_OVERSAMPLE_MAX_BITS, quiet_oversampled);
+	CHECK(fabs(quiet_oversampled - quiet) < 0.5);
+	
+	// Full scale does not overflow the accumulator
+	noise_lsb = 0.0;
+	analog_value = 1023.0;
+	CHECK_EQUAL(1023UL << ADC_OVERSAMPLE_MAX_BITS, oversample(ADC2, ADC_OVERSAMPLE_MAX_BITS));
+	CHECK_EQUAL(1023UL << ADC_OVERSAMPLE_MAX_BITS, oversample(ADC2, ADC_OVERSAMPLE_MAX_BITS + 1));
+	
+	// Differential noise around zero is averaged as signed values instead of wrapping to 1023
+	noise_lsb = 1.0;
+	static const double diff_values[] = { -0.4, 0.0, 0.3 };
+	for (uint8_t i = 0; i < sizeof(diff_values) / sizeof(diff_values[0]); i++)
+	{
+		analog_value = diff_values[i];
+		double estimate = ((int16_t) oversample(AMP0, ADC_OVERSAMPLE_MAX_BITS) + 0.5) / (1 << ADC_OVERSAMPLE_MAX_BITS);
+		printf("differential %.1f LSB: estimate %.2f\n", analog_value, estimate);
+		CHECK(fabs(estimate - analog_value) < 0.4);
+	}
+	
+	// Differential full scale of both signs does not overflow the accumulator
+	noise_lsb = 0.0;
+	analog_value = -512.0;
+	CHECK_EQUAL(-512L << ADC_OVERSAMPLE_MAX_BITS, (int16_t) oversample(AMP1, ADC_OVERSAMPLE_MAX_BITS));
+	analog_value = -1.0;
+	CHECK_EQUAL(-1L << ADC_OVERSAMPLE_MAX_BITS, (int16_t) oversample(AMP1, ADC_OVERSAMPLE_MAX_BITS));
+	analog_value = 511.0;
+	CHECK_EQUAL(511L << ADC_OVERSAMPLE_MAX_BITS, (int16_t) oversample(AMP2, ADC_OVERSAMPLE_MAX_BITS));
+	
+	return TEST_RESULT("test_adc_enob");
+}
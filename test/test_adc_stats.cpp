@@ -0,0 +1,152 @@
+/**
+* @file test_adc_stats.cpp
+* @brief Host test of the streaming ADC statistics: decimation, signed channels and the 32 bit variance
+*
+*/
+
+#include <avr/io.h>
+#include "sim.h"
+#include "test.h"
+#include "adc.h"
+#include "adc_stats.h"
+
+/** Simulated input of each channel */
+static uint16_t input_code[32];
+
+
+/**
+* @brief Input of the simulated ADC
+*/
+static uint16_t input(uint8_t admux)
+{
+	return input_code[admux & 0x1F];
+}
+
+
+/**
+* @brief Function to convert a sequence of values, the hook of the statistics sees every conversion
+*/
+static void convert(ADC_CH channel, const int16_t *values, uint16_t count)
+{
+	for (uint16_t i = 0; i < count; i++)
+	{
+		input_code[channel] = (uint16_t) values[i] & 0x3FF;
+		adcRead(channel);
+	}
+}
+
+
+static void testMeanVariance(void)
+{
+	static const int16_t values[] = { 100, 104, 98, 101, 97, 103, 99, 102 };
+	ADC_STATS stats;
+
+	CHECK(adcStatsEnable(0, ADC1, 1));
+	convert(ADC1, values, 8);
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(8, stats.count);
+	CHECK_EQUAL(0, stats.skipped);
+	CHECK_EQUAL(97, stats.min);
+	CHECK_EQUAL(104, stats.max);
+	CHECK_EQUAL(101, adcStatsMean(&stats));
+	// Mean 100.5, squared deviations 42: 42 / 8 = 5.25
+	CHECK_EQUAL(5, adcStatsVariance(&stats));
+
+	// The snapshot resets the accumulator
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(0, stats.count);
+	CHECK_EQUAL(0, adcStatsVariance(&stats));
+	adcStatsDisable(0);
+}
+
+
+static void testSigned(void)
+{
+	static const int16_t values[] = { -3, -1, 1, -5 };
+	ADC_STATS stats;
+
+	CHECK(adcStatsEnable(1, AMP0, 1));
+	convert(AMP0, values, 4);
+	CHECK(adcStatsSnapshot(1, &stats));
+	CHECK_EQUAL(-5, stats.min);
+	CHECK_EQUAL(1, stats.max);
+	CHECK_EQUAL(-8, stats.sum);
+	CHECK_EQUAL(-2, adcStatsMean(&stats));
+	CHECK_EQUAL(5, adcStatsVariance(&stats));
+	adcStatsDisable(1);
+}
+
+
+static void testDecimation(void)
+{
+	int16_t values[3 * ADC_STATS_MAX_COUNT / 2];
+	ADC_STATS stats;
+
+	// A ramp over more conversions than ADC_STATS_MAX_COUNT is still covered evenly
+	for (uint16_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		values[i] = i / 8;
+	}
+	CHECK(adcStatsEnable(0, ADC2, 2));
+	convert(ADC2, values, sizeof(values) / sizeof(values[0]));
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(3 * ADC_STATS_MAX_COUNT / 4, stats.count);
+	CHECK_EQUAL(0, stats.skipped);
+	CHECK_EQUAL(0, stats.min);
+	CHECK_EQUAL(767, stats.max);
+	CHECK_EQUAL(384, adcStatsMean(&stats));
+
+	// Without decimation only the start of the ramp is accumulated
+	CHECK(adcStatsEnable(0, ADC2, 1));
+	convert(ADC2, values, sizeof(values) / sizeof(values[0]));
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(ADC_STATS_MAX_COUNT, stats.count);
+	CHECK_EQUAL(ADC_STATS_MAX_COUNT / 2, stats.skipped);
+	CHECK_EQUAL(256, adcStatsMean(&stats));
+	adcStatsDisable(0);
+}
+
+
+static void testFullScaleVariance(void)
+{
+	int16_t values[ADC_STATS_MAX_COUNT];
+	ADC_STATS stats;
+
+	// Half of the samples at 0 and half at 1023: variance 511.5^2 without a 64 bit calculation
+	for (uint16_t i = 0; i < ADC_STATS_MAX_COUNT; i++)
+	{
+		values[i] = (i & 1) ? 1023 : 0;
+	}
+	CHECK(adcStatsEnable(0, ADC3, 1));
+	convert(ADC3, values, ADC_STATS_MAX_COUNT);
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(ADC_STATS_MAX_COUNT, stats.count);
+	CHECK_EQUAL(261632, adcStatsVariance(&stats));
+
+	// Constant full scale input has no variance
+	for (uint16_t i = 0; i < ADC_STATS_MAX_COUNT; i++)
+	{
+		values[i] = 1023;
+	}
+	convert(ADC3, values, ADC_STATS_MAX_COUNT);
+	CHECK(adcStatsSnapshot(0, &stats));
+	CHECK_EQUAL(1023, adcStatsMean(&stats));
+	CHECK_EQUAL(0, adcStatsVariance(&stats));
+	adcStatsDisable(0);
+}
+
+
+int main(void)
+{
+	simReset();
+	simAdcInput(input);
+	adcInit(ADC_CLK_DIV_64);
+	adcReference(ADC_INTERNAL_VCC_REF);
+
+	testMeanVariance();
+	testSigned();
+	testDecimation();
+	testFullScaleVariance();
+
+	return TEST_RESULT("test_adc_stats");
+}